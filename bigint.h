@@ -46,6 +46,8 @@ extern "C" {
  *   BIGINT_WORD_TYPE
  *   BIGINT_DEFAULT_LIMIT
  *   BIGINT_NO_MALLOC
+ *   BIGINT_SCRATCH_SIZE
+ *   BIGINT_INLINE_WORDS
  *
  * They needs to be defined before *every* #include
  * (not just the implementation include) since that
@@ -76,6 +78,14 @@ extern "C" {
 
 typedef BIGINT_WORD_TYPE bigint_word;
 
+/* with BIGINT_INLINE_WORDS defined, each bigint carries that many words
+ * in the struct itself and only allocates once it grows past them. The
+ * struct then points into itself, so it can't be moved or assigned,
+ * use bigint_copy instead. Has no effect with BIGINT_NO_MALLOC */
+#if defined(BIGINT_INLINE_WORDS) && BIGINT_INLINE_WORDS < 1
+#error BIGINT_INLINE_WORDS must be at least 1
+#endif
+
 typedef struct bigint {
     size_t size;
     size_t alloc;
@@ -95,6 +105,10 @@ typedef struct bigint {
      * .... why? */
 #else
     bigint_word *words;
+#ifdef BIGINT_INLINE_WORDS
+    /* small values live here instead of on the heap */
+    bigint_word inline_words[BIGINT_INLINE_WORDS];
+#endif
 #endif
 } bigint;
 
@@ -112,15 +126,54 @@ typedef struct bigint {
 #endif
 extern const bigint* BIGINT_ZERO;
 
+#ifndef BIGINT_NO_MALLOC
+/* memory callbacks used for all bigint storage. each one gets the user
+ * pointer first, sizes are in bytes. realloc_fn may be NULL, in which case
+ * alloc, memcpy and free are used instead */
+typedef struct bigint_allocator {
+    void* (*alloc_fn)(void* user, size_t size);
+    void* (*realloc_fn)(void* user, void* ptr, size_t old_size, size_t new_size);
+    void  (*free_fn)(void* user, void* ptr, size_t size);
+    void* user;
+} bigint_allocator;
+
+/* replaces the global allocator, NULL restores malloc/realloc/free.
+ * not thread-safe, and every bigint still holding storage must be
+ * freed by the allocator that made it */
+BIGINT_API
+void bigint_set_allocator(const bigint_allocator* a);
+
+BIGINT_API
+void bigint_get_allocator(bigint_allocator* a);
+#endif
+
 BIGINT_API
 void bigint_init(bigint* b);
 
 BIGINT_API
 void bigint_free(bigint* b);
 
+/* makes room for a value of up to bits bits without changing b, so
+ * growing to that size doesn't reallocate */
+BIGINT_API
+int bigint_reserve(bigint* b, size_t bits);
+
+/* releases any storage b's current value doesn't need */
+BIGINT_API
+int bigint_shrink_to_fit(bigint* b);
+
 BIGINT_API
 int bigint_copy(bigint* b, const bigint* a);
 
+#ifndef BIGINT_NO_MALLOC
+/* points b at size words owned by the caller, least significant first,
+ * without copying them. b is read-only: pass it only as a const input,
+ * and bigint_free it (which releases nothing) before reusing it. the
+ * words must stay valid and unchanged for as long as b is in use */
+BIGINT_API
+void bigint_view(bigint* b, const bigint_word* words, size_t size, int negative);
+#endif
+
 BIGINT_API
 int bigint_from_word(bigint* b, bigint_word val);
 
@@ -131,6 +184,44 @@ int bigint_from_string(bigint* b, const char* str, size_t len, unsigned int base
 BIGINT_API
 int bigint_from_cstring(bigint* b, const char* str, unsigned int base);
 
+typedef struct bigint_pow10_cache bigint_pow10_cache;
+
+#ifndef BIGINT_NO_MALLOC
+/* the powers of ten long decimal strings and large numbers are split
+ * by when converting between them, kept from call to call so converting
+ * many of them builds each power once. Set up with
+ * bigint_pow10_cache_init, release with bigint_pow10_cache_free. One
+ * cache must not be used by two threads at once */
+struct bigint_pow10_cache {
+    bigint pow[sizeof(size_t) * CHAR_BIT]; /* 10^(BIGINT_STRING_DC_DIGITS << j) */
+    size_t count; /* entries built so far */
+};
+
+BIGINT_API
+void bigint_pow10_cache_init(bigint_pow10_cache* c);
+
+BIGINT_API
+void bigint_pow10_cache_free(bigint_pow10_cache* c);
+
+/* bigint_from_string, keeping the powers of ten it needs in c */
+BIGINT_API
+int bigint_from_string_cached(bigint* b, const char* str, size_t len, unsigned int base, bigint_pow10_cache* c);
+
+/* bigint_to_string, keeping the powers of ten it needs in c */
+BIGINT_API
+size_t bigint_to_string_cached(char* str, size_t len, const bigint* b, unsigned int base, bigint_pow10_cache* c);
+#endif
+
+/* reads count words of size bytes each from data, like GMP's mpz_import.
+ * order is 1 for the most significant word first, -1 for least
+ * significant first. endian is the byte order within each word, 1 for
+ * big-endian, -1 for little-endian, 0 for the host's. With
+ * twos_complement set the data is a signed two's complement number,
+ * otherwise it's unsigned. Returns BIGINT_EINVAL for a bad
+ * order/endian/size */
+BIGINT_API
+int bigint_import_bytes(bigint* b, size_t count, int order, size_t size, int endian, int twos_complement, const void* data);
+
 BIGINT_API
 int bigint_from_u8(bigint* b, uint8_t val);
 
@@ -182,9 +273,30 @@ int bigint_to_u64(uint64_t * val, const bigint* b);
 BIGINT_API
 int bigint_to_i64(int64_t * val, const bigint* b);
 
+/* with str NULL, returns a buffer size that's enough for the string
+ * (in base 10 it can be one more than needed). Doesn't write a NUL.
+ * Returns 0 on error, which includes running out of memory. Outside
+ * the power of two bases that can happen with a short buffer too,
+ * since finding which digits to keep may need a power of the base */
 BIGINT_API
 size_t bigint_to_string(char* str, size_t len, const bigint* b, unsigned int base);
 
+/* the exact number of characters bigint_to_string writes given enough
+ * room. Returns 0 for an unsupported base. For bases that aren't a
+ * power of two it also returns 0 if there's not enough memory for the
+ * power of the base it needs when b is close to one */
+BIGINT_API
+size_t bigint_strlen_exact(const bigint* b, unsigned int base);
+
+/* the reverse of bigint_import_bytes, writes the fewest words that hold
+ * b (none for zero) and sets *count to how many. Without
+ * twos_complement only the magnitude is written. On the way in *count
+ * is how many words data has room for, if that's too few *count is
+ * set to the number needed and it returns BIGINT_ELIMIT. With data
+ * NULL it just sets *count */
+BIGINT_API
+int bigint_export_bytes(void* data, size_t* count, int order, size_t size, int endian, int twos_complement, const bigint* b);
+
 BIGINT_API
 int bigint_cmp(const bigint *a, const bigint *b);
 
@@ -209,9 +321,86 @@ int bigint_sub(bigint* c, const bigint* a, const bigint* b);
 BIGINT_API
 int bigint_mul(bigint* c, const bigint* a, const bigint* b);
 
+/* equivalent to bigint_mul(c, a, a), but roughly half the work */
+BIGINT_API
+int bigint_sqr(bigint* c, const bigint* a);
+
+/* truncating division, the remainder takes the sign of the numerator.
+ * returns BIGINT_EINVAL if denominator is zero */
 BIGINT_API
 int bigint_div_mod(bigint* quotient, bigint* remainder, const bigint* numerator, const bigint* denominator);
 
+/* a precomputed reciprocal, for dividing many numbers by the same
+ * denominator. Set up with bigint_preinv_init, release with
+ * bigint_preinv_free */
+typedef struct bigint_preinv {
+    bigint d;     /* |denominator|, shifted so its top bit is set */
+    bigint v;     /* floor(B^(2n) / d) with n = d.size, left empty
+                   * when d is below BIGINT_BZ_THRESHOLD words */
+    size_t shift; /* bits d was shifted by */
+    size_t sign;  /* sign of the denominator */
+} bigint_preinv;
+
+/* returns BIGINT_EINVAL if denominator is zero */
+BIGINT_API
+int bigint_preinv_init(bigint_preinv* p, const bigint* denominator);
+
+BIGINT_API
+void bigint_preinv_free(bigint_preinv* p);
+
+/* same results as bigint_div_mod(quotient, remainder, numerator, denominator)
+ * with the denominator p was set up with, but each n-word block of the
+ * numerator takes two multiplications instead of a long division */
+BIGINT_API
+int bigint_div_mod_preinv(bigint* quotient, bigint* remainder, const bigint* numerator, const bigint_preinv* p);
+
+typedef struct bigint_scratch bigint_scratch;
+
+#ifndef BIGINT_NO_MALLOC
+/* temporaries for the _scratch versions of the arithmetic functions.
+ * Each slot keeps its storage from call to call, so once they've grown
+ * to the sizes in use no more memory is allocated. Set up with
+ * bigint_scratch_init, release with bigint_scratch_free. One scratch
+ * must not be used by two threads at once */
+#ifndef BIGINT_SCRATCH_SIZE
+#define BIGINT_SCRATCH_SIZE 4
+#endif
+
+#if BIGINT_SCRATCH_SIZE < 1
+#error BIGINT_SCRATCH_SIZE must be at least 1
+#endif
+
+struct bigint_scratch {
+    bigint slots[BIGINT_SCRATCH_SIZE];
+    size_t used; /* slots currently handed out */
+};
+
+BIGINT_API
+void bigint_scratch_init(bigint_scratch* s);
+
+/* returns every slot to the scratch without releasing its storage */
+BIGINT_API
+void bigint_scratch_reset(bigint_scratch* s);
+
+BIGINT_API
+void bigint_scratch_free(bigint_scratch* s);
+
+BIGINT_API
+int bigint_add_scratch(bigint* c, const bigint* a, const bigint* b, bigint_scratch* s);
+
+BIGINT_API
+int bigint_sub_scratch(bigint* c, const bigint* a, const bigint* b, bigint_scratch* s);
+
+BIGINT_API
+int bigint_mul_scratch(bigint* c, const bigint* a, const bigint* b, bigint_scratch* s);
+
+BIGINT_API
+int bigint_sqr_scratch(bigint* c, const bigint* a, bigint_scratch* s);
+
+BIGINT_API
+int bigint_div_mod_scratch(bigint* quotient, bigint* remainder, const bigint* numerator, const bigint* denominator, bigint_scratch* s);
+#endif
+
 BIGINT_API
 int bigint_lshift(bigint* c, const bigint* a, size_t bits);
 
@@ -224,13 +413,24 @@ int bigint_lshift_overwrite(bigint* a, size_t bits);
 BIGINT_API
 int bigint_rshift_overwrite(bigint* a, size_t bits);
 
-/* faster div_mod for when you're dividing by a regular, positive word type - note that this
- * overwrites numerator! roughly equivalent to:
+/* faster div_mod for when you're dividing by a regular, positive (non-zero) word type - note
+ * that this overwrites numerator! roughly equivalent to:
  * remainder = numerator % denominator
  * numerator /= denominator */
 BIGINT_API
 void bigint_div_mod_word(bigint* numerator, bigint_word* remainder, bigint_word denominator);
 
+/* divides when the division is known to leave no remainder (the result
+ * is meaningless otherwise), much faster than bigint_div_mod.
+ * Returns BIGINT_EINVAL if denominator is zero */
+BIGINT_API
+int bigint_divexact(bigint* quotient, const bigint* numerator, const bigint* denominator);
+
+/* word version of bigint_divexact, overwrites numerator with
+ * numerator / denominator. denominator must be non-zero */
+BIGINT_API
+void bigint_divexact_word(bigint* numerator, bigint_word denominator);
+
 
 #ifdef __cplusplus
 }
@@ -242,6 +442,82 @@ void bigint_div_mod_word(bigint* numerator, bigint_word* remainder, bigint_word
 
 #define BIGINT_BLOCK_SIZE 8
 
+/* operands (in words) at or above this size use Karatsuba multiplication,
+ * smaller operands use the schoolbook method */
+#ifndef BIGINT_KARATSUBA_THRESHOLD
+#define BIGINT_KARATSUBA_THRESHOLD 48
+#endif
+
+#if BIGINT_KARATSUBA_THRESHOLD < 2
+#error BIGINT_KARATSUBA_THRESHOLD must be at least 2
+#endif
+
+/* operands (in words) at or above this size use Toom-3 multiplication */
+#ifndef BIGINT_TOOM3_THRESHOLD
+#define BIGINT_TOOM3_THRESHOLD 192
+#endif
+
+#if BIGINT_TOOM3_THRESHOLD < 3
+#error BIGINT_TOOM3_THRESHOLD must be at least 3
+#endif
+
+/* operands (in words) at or above this size use number-theoretic
+ * transform multiplication (not available with BIGINT_NO_MALLOC).
+ * The transform works on 16-bit digits no matter the word size, so
+ * wider words push the crossover point out further */
+#ifndef BIGINT_NTT_THRESHOLD
+#if BIGINT_WORD_WIDTH == 1
+#define BIGINT_NTT_THRESHOLD 512
+#elif BIGINT_WORD_WIDTH == 2
+#define BIGINT_NTT_THRESHOLD 1024
+#elif BIGINT_WORD_WIDTH == 4
+#define BIGINT_NTT_THRESHOLD 6144
+#else
+#define BIGINT_NTT_THRESHOLD 20480
+#endif
+#endif
+
+/* divisors and quotients (in words) at or above this size use
+ * Burnikel-Ziegler recursive division (not available with
+ * BIGINT_NO_MALLOC), smaller ones use Knuth's algorithm D */
+#ifndef BIGINT_BZ_THRESHOLD
+#define BIGINT_BZ_THRESHOLD 96
+#endif
+
+#if BIGINT_BZ_THRESHOLD < 2
+#error BIGINT_BZ_THRESHOLD must be at least 2
+#endif
+
+/* decimal strings longer than twice this many words' worth of digits,
+ * and numbers of at least twice this many words, are converted by
+ * divide and conquer (not available with BIGINT_NO_MALLOC), smaller
+ * ones a word of digits at a time */
+#ifndef BIGINT_STRING_DC_THRESHOLD
+#define BIGINT_STRING_DC_THRESHOLD 16
+#endif
+
+#if BIGINT_STRING_DC_THRESHOLD < 1
+#error BIGINT_STRING_DC_THRESHOLD must be at least 1
+#endif
+
+/* the largest power of ten that fits in a word, and its number of
+ * digits, used to convert decimal strings a chunk of digits at a time */
+#if BIGINT_WORD_WIDTH == 1
+#define BIGINT_WORD_DIGITS10 2
+#define BIGINT_WORD_POW10 ((bigint_word)100U)
+#elif BIGINT_WORD_WIDTH == 2
+#define BIGINT_WORD_DIGITS10 4
+#define BIGINT_WORD_POW10 ((bigint_word)10000U)
+#elif BIGINT_WORD_WIDTH == 4
+#define BIGINT_WORD_DIGITS10 9
+#define BIGINT_WORD_POW10 ((bigint_word)1000000000UL)
+#else
+#define BIGINT_WORD_DIGITS10 19
+#define BIGINT_WORD_POW10 ((bigint_word)10000000000000000000ULL)
+#endif
+
+#define BIGINT_STRING_DC_DIGITS (BIGINT_STRING_DC_THRESHOLD * BIGINT_WORD_DIGITS10)
+
 #if __GNUC__ > 4 || \
    (__GNUC__ == 4 && __GNUC_MINOR__ >= 5)
 #define BIGINT_UNREACHABLE __builtin_unreachable()
@@ -306,8 +582,51 @@ static const bigint BIGINT_ZERO_STORAGE = { .words = NULL, .size = 0, .alloc = 0
 #endif
 const bigint* BIGINT_ZERO = &BIGINT_ZERO_STORAGE;
 
+#ifndef BIGINT_NO_MALLOC
+static void* bigint_default_alloc(void* user, size_t size) {
+    (void)user;
+    return malloc(size);
+}
+
+static void* bigint_default_realloc(void* user, void* ptr, size_t old_size, size_t new_size) {
+    (void)user;
+    (void)old_size;
+    return realloc(ptr, new_size);
+}
+
+static void bigint_default_free(void* user, void* ptr, size_t size) {
+    (void)user;
+    (void)size;
+    free(ptr);
+}
+
+static bigint_allocator bigint_allocator_hooks = {
+    bigint_default_alloc, bigint_default_realloc, bigint_default_free, NULL
+};
+
+static void* bigint_mem_alloc(size_t size) {
+    return bigint_allocator_hooks.alloc_fn(bigint_allocator_hooks.user, size);
+}
+
+static void* bigint_mem_realloc(void* ptr, size_t old_size, size_t new_size) {
+    void* p;
+    if(bigint_allocator_hooks.realloc_fn != NULL) {
+        return bigint_allocator_hooks.realloc_fn(bigint_allocator_hooks.user, ptr, old_size, new_size);
+    }
+    if( (p = bigint_mem_alloc(new_size)) == NULL) return NULL;
+    memcpy(p, ptr, old_size < new_size ? old_size : new_size);
+    bigint_allocator_hooks.free_fn(bigint_allocator_hooks.user, ptr, old_size);
+    return p;
+}
+
+static void bigint_mem_free(void* ptr, size_t size) {
+    bigint_allocator_hooks.free_fn(bigint_allocator_hooks.user, ptr, size);
+}
+#endif
+
 static void bigint_reset(bigint* b);
 static int  bigint_resize(bigint* b, size_t size);
+static int  bigint_resize_uninit(bigint* b, size_t size);
 static inline void bigint_truncate(bigint* b);
 static int  bigint_append(bigint* b, bigint_word val);
 
@@ -321,20 +640,34 @@ static bigint_word bigint_word_mul(bigint_word *a, bigint_word b);
 static int bigint_add_unsigned(bigint* a, const bigint* b);
 static int bigint_sub_unsigned(bigint* a, const bigint* b);
 
+static int bigint_rsub_unsigned(bigint* a, const bigint* b);
+
 static int bigint_add_signed(bigint* c, const bigint* a, size_t a_sign, const bigint* b, size_t b_sign);
+static int bigint_acc_signed(bigint* a, const bigint* b, size_t negate);
 
 static int bigint_cmp_abs(const bigint* a, const bigint* b);
 
 static int bigint_mul_long(bigint* c, const bigint* a, const bigint* b);
+static int bigint_mul_karatsuba(bigint* c, const bigint* a, const bigint* b);
+static int bigint_mul_toom3(bigint* c, const bigint* a, const bigint* b);
+#ifndef BIGINT_NO_MALLOC
+static int bigint_mul_ntt(bigint* c, const bigint* a, const bigint* b);
+#endif
+static int bigint_mul_unsigned(bigint* c, const bigint* a, const bigint* b);
+static int bigint_sqr_long(bigint* c, const bigint* a);
+static int bigint_sqr_unsigned(bigint* c, const bigint* a);
+
+static int bigint_slice(bigint* b, const bigint* a, size_t start, size_t len);
+static int bigint_add_shifted_unsigned(bigint* c, const bigint* a, size_t words);
 
 static size_t bigint_bitlength(const bigint* a);
 static int bigint_get_bit(const bigint* a, size_t b);
 static int bigint_set_bit(bigint* a, size_t b, uint8_t val);
 static int bigint_from_string_base16(bigint* b, const char* str, size_t len);
-static int bigint_from_string_base10(bigint* b, const char* str, size_t len);
+static int bigint_from_string_base10(bigint* b, const char* str, size_t len, bigint_pow10_cache* c);
 static int bigint_from_string_base8(bigint* b, const char* str, size_t len);
 static int bigint_from_string_base2(bigint* b, const char* str, size_t len);
-static int bigint_from_string_base0(bigint* b, const char* str, size_t len);
+static int bigint_from_string_base0(bigint* b, const char* str, size_t len, bigint_pow10_cache* c);
 
 /* returns the length of a string for the given base */
 static size_t bigint_len_string_base16(const bigint* b);
@@ -343,13 +676,13 @@ static size_t bigint_len_string_base8(const bigint* b);
 static size_t bigint_len_string_base2(const bigint* b);
 
 BIGINT_NONNULL1
-static size_t bigint_to_string_base16(char* str, size_t len, bigint* b);
+static size_t bigint_to_string_base16(char* str, size_t len, const bigint* b);
 BIGINT_NONNULL1
-static size_t bigint_to_string_base10(char* str, size_t len, bigint* b);
+static size_t bigint_to_string_base10(char* str, size_t len, bigint* b, bigint_pow10_cache* c);
 BIGINT_NONNULL1
-static size_t bigint_to_string_base8(char* str, size_t len, bigint* b);
+static size_t bigint_to_string_base8(char* str, size_t len, const bigint* b);
 BIGINT_NONNULL1
-static size_t bigint_to_string_base2(char* str, size_t len, bigint* b);
+static size_t bigint_to_string_base2(char* str, size_t len, const bigint* b);
 
 static
 void bigint_reset(bigint* b) {
@@ -361,46 +694,137 @@ void bigint_reset(bigint* b) {
         b->words[0] = 0;
 }
 
+#ifndef BIGINT_NO_MALLOC
+/* moves b to storage for exactly alloc words (the inline words when
+ * they're enough, none for 0), keeping its value. alloc must be at
+ * least b->size, words past the size aren't initialized */
 static
-int bigint_resize(bigint* b, size_t size) {
+int bigint_set_alloc(bigint* b, size_t alloc) {
+    bigint_word* words;
+    int heap = b->alloc != 0;
+
+#ifdef BIGINT_INLINE_WORDS
+    heap = heap && b->words != b->inline_words;
+    if(alloc != 0 && alloc <= BIGINT_INLINE_WORDS) alloc = BIGINT_INLINE_WORDS;
+#endif
+    if(alloc == b->alloc) return 0;
+
+#ifdef BIGINT_INLINE_WORDS
+    if(heap && alloc > BIGINT_INLINE_WORDS) {
+#else
+    if(heap && alloc != 0) {
+#endif
+        words = (bigint_word *)bigint_mem_realloc(b->words,b->alloc * BIGINT_WORD_SIZE,alloc * BIGINT_WORD_SIZE);
+        if(words == NULL) return BIGINT_ENOMEM;
+    } else {
+        if(alloc == 0) {
+            words = NULL;
+#ifdef BIGINT_INLINE_WORDS
+        } else if(alloc == BIGINT_INLINE_WORDS) {
+            words = b->inline_words;
+#endif
+        } else {
+            words = (bigint_word *)bigint_mem_alloc(alloc * BIGINT_WORD_SIZE);
+            if(words == NULL) return BIGINT_ENOMEM;
+        }
+        /* the old words may be a view, only the value is carried over */
+        if(b->size) memcpy(words,b->words,b->size * BIGINT_WORD_SIZE);
+        if(heap) bigint_mem_free(b->words,b->alloc * BIGINT_WORD_SIZE);
+    }
+
+    b->words = words;
+    b->alloc = alloc;
+    return 0;
+}
+#endif
+
+/* bigint_resize without clearing the new words, for callers that
+ * write every one of them */
+static
+int bigint_resize_uninit(bigint* b, size_t size) {
 #ifdef BIGINT_NO_MALLOC
     size_t alloc = size;
     if(alloc * BIGINT_WORD_SIZE > BIGINT_DEFAULT_LIMIT) return BIGINT_ENOMEM;
 #else
+    int r;
+    size_t grow, cap;
     size_t alloc = ((size + BIGINT_BLOCK_SIZE-1)) & -BIGINT_BLOCK_SIZE;
 #endif
 
     if(alloc * BIGINT_WORD_SIZE > b->limit) return BIGINT_ELIMIT;
 
 #ifndef BIGINT_NO_MALLOC
-    if(b->alloc < alloc) {
-        if(b->words != NULL) {
-            b->words = (bigint_word *)realloc(b->words,alloc * BIGINT_WORD_SIZE);
-        } else {
-            b->words = (bigint_word *)malloc(alloc * BIGINT_WORD_SIZE);
+    if(b->alloc < size) {
+        /* grow by half again, so a value built up a word at a time
+         * is only reallocated a logarithmic number of times */
+        grow = (b->alloc + b->alloc / 2 + BIGINT_BLOCK_SIZE-1) & -BIGINT_BLOCK_SIZE;
+        if(grow > alloc) {
+            cap = (b->limit / BIGINT_WORD_SIZE) & -BIGINT_BLOCK_SIZE;
+            alloc = grow < cap ? grow : cap;
         }
-        if(b->words == NULL) return BIGINT_ENOMEM;
-        memset(&b->words[b->alloc],0,(alloc - b->alloc) * BIGINT_WORD_SIZE);
-        b->alloc = alloc;
+#ifdef BIGINT_INLINE_WORDS
+        if(size <= BIGINT_INLINE_WORDS) alloc = size;
+#endif
+        if( (r = bigint_set_alloc(b,alloc)) != 0) return r;
     }
 #endif
 
     if(b->size > size) { /* shrinking */
         b->words[size] = 0;
-    } else if(b->size < size) { /* growing */
-        b->words[b->size] = 0;
     }
 
     b->size = size;
     return 0;
 }
 
+static
+int bigint_resize(bigint* b, size_t size) {
+    int r;
+    size_t old_size = b->size;
+
+    if( (r = bigint_resize_uninit(b,size)) != 0) return r;
+    if(old_size < size) { /* growing */
+        memset(&b->words[old_size],0,(size - old_size) * BIGINT_WORD_SIZE);
+    }
+    return 0;
+}
+
 static inline
 void bigint_truncate(bigint* b) {
     while(b->size && b->words[b->size - 1] == 0) b->size--;
     b->sign = b->size && b->sign;
 }
 
+/* hands out an empty temporary, from s if it has a free slot and
+ * otherwise local (which must be initialized) */
+static
+bigint* bigint_tmp_take(bigint_scratch* s, bigint* local, size_t limit) {
+    bigint* t = local;
+#ifndef BIGINT_NO_MALLOC
+    if(s != NULL && s->used < BIGINT_SCRATCH_SIZE) t = &s->slots[s->used++];
+#else
+    (void)s;
+#endif
+    bigint_reset(t);
+    t->limit = limit;
+    return t;
+}
+
+/* gives back a temporary from bigint_tmp_take, in reverse order */
+static
+void bigint_tmp_give(bigint_scratch* s, bigint* t, bigint* local) {
+    if(t == local) {
+        bigint_free(local);
+        return;
+    }
+#ifndef BIGINT_NO_MALLOC
+    assert(t == &s->slots[s->used - 1]);
+    s->used--;
+#else
+    (void)s;
+#endif
+}
+
 static inline
 size_t bigint_word_bitlength(bigint_word a) {
 #if defined(_WIN32) && BIGINT_WORD_WIDTH <= 4
@@ -437,7 +861,7 @@ static inline
 int bigint_get_bit(const bigint* a, size_t b) {
     size_t word = b / BIGINT_WORD_BIT;
     size_t bit = b % BIGINT_WORD_BIT;
-    if(word > a->size) return 0;
+    if(word >= a->size) return 0;
     return (a->words[word] >> bit) & 1;
 }
 
@@ -568,6 +992,99 @@ static bigint_word bigint_word_mul(bigint_word *a, bigint_word b) {
 #endif
 }
 
+/* divides the double word hi:lo by d and returns the quotient, the
+ * remainder goes into *rem. requires hi < d and the top bit of d set
+ * (the divisor normalization of Knuth's algorithm D) */
+static inline
+bigint_word bigint_word_div2(bigint_word hi, bigint_word lo, bigint_word d, bigint_word* rem) {
+#if !defined(BIGINT_SINGLE_WORD_ONLY) && defined(BIGINT_DWORD_TYPE)
+    BIGINT_DWORD_TYPE n;
+    n = hi;
+    n <<= BIGINT_WORD_BIT;
+    n |= lo;
+    *rem = (bigint_word)(n % d);
+    return (bigint_word)(n / d);
+#else
+    /* schoolbook division of a 4-digit number by a 2-digit number,
+     * using half-words as digits (see divlu in Hacker's Delight) */
+    bigint_word d1, d0, n1, n0, q1, q0, rhat, t;
+
+    d1 = d >> BIGINT_HALF_WORD_BIT;
+    d0 = d & BIGINT_HALF_WORD_MASK;
+    n1 = lo >> BIGINT_HALF_WORD_BIT;
+    n0 = lo & BIGINT_HALF_WORD_MASK;
+
+    q1 = hi / d1;
+    rhat = hi - q1 * d1;
+    while(q1 > BIGINT_HALF_WORD_MASK || (bigint_word)(q1 * d0) > (bigint_word)((rhat << BIGINT_HALF_WORD_BIT) | n1)) {
+        q1--;
+        rhat += d1;
+        if(rhat > BIGINT_HALF_WORD_MASK) break;
+    }
+
+    /* these wrap around, but the true value is below d */
+    t = (bigint_word)((bigint_word)(hi << BIGINT_HALF_WORD_BIT) + n1 - (bigint_word)(q1 * d));
+
+    q0 = t / d1;
+    rhat = t - q0 * d1;
+    while(q0 > BIGINT_HALF_WORD_MASK || (bigint_word)(q0 * d0) > (bigint_word)((rhat << BIGINT_HALF_WORD_BIT) | n0)) {
+        q0--;
+        rhat += d1;
+        if(rhat > BIGINT_HALF_WORD_MASK) break;
+    }
+
+    *rem = (bigint_word)((bigint_word)(t << BIGINT_HALF_WORD_BIT) + n0 - (bigint_word)(q0 * d));
+    return (bigint_word)((q1 << BIGINT_HALF_WORD_BIT) | q0);
+#endif
+}
+
+/* v = floor((B^2 - 1) / d) - B, the reciprocal of a normalized d
+ * used by bigint_word_div2_preinv */
+static inline
+bigint_word bigint_word_inverse(bigint_word d) {
+    bigint_word r;
+    return bigint_word_div2((bigint_word)~d, BIGINT_WORD_MASK, d, &r);
+}
+
+/* same as bigint_word_div2, but with the division replaced by two
+ * multiplications using v = bigint_word_inverse(d), see N. Moller and
+ * T. Granlund, "Improved division by invariant integers" (2011) */
+static inline
+bigint_word bigint_word_div2_preinv(bigint_word hi, bigint_word lo, bigint_word d, bigint_word v, bigint_word* rem) {
+    bigint_word q0, q1, r;
+
+    q0 = v;
+    q1 = bigint_word_mul(&q0, hi);
+    q1 += bigint_word_add(&q0, lo);
+    q1 += hi + 1;
+
+    r = (bigint_word)(lo - (bigint_word)(1u * q1 * d)); /* 1u keeps narrow words from promoting to int */
+    if(r > q0) {
+        q1--;
+        r += d;
+    }
+    if(r >= d) {
+        q1++;
+        r -= d;
+    }
+
+    *rem = r;
+    return q1;
+}
+
+/* inverse of an odd word modulo B, with Newton's iteration
+ * x' = x * (2 - d * x) doubling the number of correct low bits */
+static inline
+bigint_word bigint_word_inverse_2adic(bigint_word d) {
+    bigint_word x = d; /* d * d == 1 (mod 8) for any odd d */
+    size_t bits;
+
+    for(bits = 3; bits < BIGINT_WORD_BIT; bits *= 2) {
+        x = (bigint_word)(1u * x * (bigint_word)(2 - (bigint_word)(1u * d * x)));
+    }
+    return x;
+}
+
 #if defined(BIGINT_SINGLE_WORD_ONLY) || !defined(BIGINT_WORD_MUL_DOUBLE)
 #define BIGINT_WORD_MUL_CONST(x) \
 static inline bigint_word bigint_word_mul_const_ ## x (bigint_word *a) { \
@@ -682,6 +1199,25 @@ static int bigint_sub_unsigned(bigint* a, const bigint* b) {
     return 0;
 }
 
+/* performs a = b - a, ignoring signs, requires |b| >= |a| */
+static int bigint_rsub_unsigned(bigint* a, const bigint* b) {
+    int r;
+    size_t i;
+    bigint_word carry = 0;
+    bigint_word tmp;
+
+    if( (r = bigint_resize(a,b->size)) != 0) return r;
+
+    for(i = 0; i < b->size; i++) {
+        tmp = b->words[i];
+        carry = bigint_word_sub(&tmp,carry);
+        carry += bigint_word_sub(&tmp,a->words[i]);
+        a->words[i] = tmp;
+    }
+    bigint_truncate(a);
+    return 0;
+}
+
 static
 int bigint_cmp_abs(const bigint* a, const bigint* b) {
     size_t i;
@@ -707,7 +1243,7 @@ int bigint_lshift_overwrite(bigint* c, size_t bits) {
 
     expanded = c->size + words + (bits != 0);
 
-    if( (r = bigint_resize(c,expanded)) != 0) return r;
+    if( (r = bigint_resize_uninit(c,expanded)) != 0) return r;
 
     if(bits == 0) {
         i = expanded;
@@ -778,26 +1314,6 @@ int bigint_rshift_overwrite(bigint* c, size_t bits) {
     return 0;
 }
 
-#define BIGINT_RSHIFT_OVERWRITE_SMALL(x) \
-static inline void bigint_rshift_overwrite_small_ ## x (bigint* c) { \
-    size_t i; \
-    bigint_word lo, hi; \
-    i = 0; \
-    lo = hi = c->words[0]; \
-    while(i < c->size - 1) { \
-        hi = c->words[i + 1]; \
-        c->words[i] = (hi << (BIGINT_WORD_BIT - x)) | lo >> x; \
-        lo = hi; \
-        i++; \
-    } \
-    c->words[i] = lo >> x; \
-    bigint_truncate(c); \
-}
-
-BIGINT_RSHIFT_OVERWRITE_SMALL(4)
-BIGINT_RSHIFT_OVERWRITE_SMALL(3)
-BIGINT_RSHIFT_OVERWRITE_SMALL(1)
-
 BIGINT_API
 int bigint_rshift(bigint* c, const bigint* a, size_t bits) {
     int r;
@@ -819,7 +1335,8 @@ int bigint_mul_long(bigint* c, const bigint* a, const bigint* b) {
 
     expanded = a->size + b->size + 1;
 
-    if( (r = bigint_resize(c, expanded)) != 0) return r;
+    if( (r = bigint_resize_uninit(c, expanded)) != 0) return r;
+    memset(c->words, 0, expanded * BIGINT_WORD_SIZE);
     c->sign = a->sign ^ b->sign;
 
     for(ib = 0; ib < b->size; ib++) {
@@ -848,42 +1365,710 @@ int bigint_mul_long(bigint* c, const bigint* a, const bigint* b) {
     return 0;
 }
 
-static int bigint_mul_word(bigint* a, bigint_word val) {
+/* schoolbook squaring, every cross product a[i] * a[j] (i < j) is
+ * computed once and doubled, then the squares a[i]^2 are added in */
+static
+int bigint_sqr_long(bigint* c, const bigint* a) {
     int r;
-    size_t i = 0;
-    bigint_word carry = 0;
-    bigint_word c = 0;
+    size_t expanded;
+    size_t i, j;
+    bigint_word carry;
+    bigint_word lo, hi;
+#if !defined(BIGINT_SINGLE_WORD_ONLY) && defined(BIGINT_DWORD_TYPE)
+    BIGINT_DWORD_TYPE res;
+#endif
 
-    if(!val) {
-        a->size = 0;
-        a->sign = 0;
-        return 0;
+    expanded = 2 * a->size + 1;
+
+    if( (r = bigint_resize_uninit(c, expanded)) != 0) return r;
+    memset(c->words, 0, expanded * BIGINT_WORD_SIZE);
+    c->sign = 0;
+
+    for(i = 0; i < a->size; i++) {
+        carry = 0;
+        for(j = i + 1; j < a->size; j++) {
+#if defined(BIGINT_SINGLE_WORD_ONLY) || !defined(BIGINT_DWORD_TYPE)
+            lo = a->words[j];
+            hi = bigint_word_mul(&lo,a->words[i]);
+            hi += bigint_word_add(&lo,c->words[i + j]);
+            hi += bigint_word_add(&lo,carry);
+            c->words[i + j] = lo;
+            carry = hi;
+#else
+            res = a->words[j];
+            res *= a->words[i];
+            res += c->words[i + j];
+            res += carry;
+            c->words[i + j] = res & BIGINT_WORD_MASK;
+            carry = res >> BIGINT_WORD_BIT;
+#endif
+        }
+        c->words[i + a->size] = carry;
+    }
+
+    /* double the cross products, they're below a^2 / 2 so this
+     * can't carry out of the top word */
+    i = expanded;
+    while(--i > 0) {
+        c->words[i] = (c->words[i] << 1) | (c->words[i - 1] >> (BIGINT_WORD_BIT - 1));
     }
+    c->words[0] <<= 1;
 
     carry = 0;
-    for(i=0;i<a->size;i++) {
-        c = bigint_word_mul(&a->words[i],val);
-        c += bigint_word_add(&a->words[i],carry);
-        carry = c;
+    for(i = 0; i < a->size; i++) {
+        lo = a->words[i];
+        hi = bigint_word_mul(&lo,a->words[i]);
+        hi += bigint_word_add(&c->words[2 * i],carry);
+        hi += bigint_word_add(&c->words[2 * i],lo);
+        carry = bigint_word_add(&c->words[2 * i + 1],hi);
     }
-    if(carry) {
-        if( (r = bigint_append(a, carry)) != 0) return r;
+    c->words[2 * a->size] += carry;
+
+    bigint_truncate(c);
+    return 0;
+}
+
+/* sets b to the words [start, start + len) of a, ignoring the sign */
+static
+int bigint_slice(bigint* b, const bigint* a, size_t start, size_t len) {
+    int r;
+
+    if(start >= a->size) {
+        b->size = 0;
+        b->sign = 0;
+        return 0;
     }
+    if(start + len > a->size) len = a->size - start;
 
-    bigint_truncate(a);
+    if( (r = bigint_resize_uninit(b, len)) != 0) return r;
+    memcpy(b->words, &a->words[start], len * BIGINT_WORD_SIZE);
+    b->sign = 0;
+    bigint_truncate(b);
     return 0;
 }
 
-#define BIGINT_MUL_CONST(x) \
-static inline int bigint_mul_const_ ## x (bigint* a) { \
-    int r; \
-    size_t i = 0; \
-    bigint_word carry = 0; \
-    bigint_word c = 0; \
-    for(i=0;i<a->size;i++) { \
-        c = bigint_word_mul_const_ ## x (&a->words[i]); \
-        c += bigint_word_add(&a->words[i],carry); \
-        carry = c; \
+/* performs c += a << (words * BIGINT_WORD_BIT), ignoring signs */
+static
+int bigint_add_shifted_unsigned(bigint* c, const bigint* a, size_t words) {
+    int r;
+    size_t i, max_size;
+    bigint_word carry = 0;
+
+    if(a->size == 0) return 0;
+
+    max_size = a->size + words;
+    if(max_size < c->size) max_size = c->size;
+
+    if( (r = bigint_resize(c, max_size)) != 0) return r;
+
+    i = 0;
+    while(i < a->size) {
+        carry = bigint_word_add(&c->words[i + words], carry);
+        carry += bigint_word_add(&c->words[i + words], a->words[i]);
+        i++;
+    }
+    i += words;
+    while(i < max_size && carry) {
+        carry = bigint_word_add(&c->words[i], carry);
+        i++;
+    }
+    if(carry) {
+        if( (r = bigint_append(c, carry)) != 0) return r;
+    }
+
+    bigint_truncate(c);
+    return 0;
+}
+
+/* Karatsuba multiplication, splitting both operands at m words:
+ *   a = a1 * B^m + a0
+ *   b = b1 * B^m + b0
+ *   a * b = z2 * B^2m + z1 * B^m + z0
+ * where
+ *   z0 = a0 * b0
+ *   z2 = a1 * b1
+ *   z1 = (a0 + a1) * (b0 + b1) - z0 - z2
+ *
+ * c must not alias a or b. The pieces are multiplied with
+ * bigint_mul_unsigned, so large pieces recurse back here and
+ * small ones end up in bigint_mul_long. */
+static
+int bigint_mul_karatsuba(bigint* c, const bigint* a, const bigint* b) {
+    int r;
+    size_t m;
+    const bigint* t;
+    const bigint* y0;
+    const bigint* y1;
+    bigint a0 = BIGINT_INIT;
+    bigint a1 = BIGINT_INIT;
+    bigint b0 = BIGINT_INIT;
+    bigint b1 = BIGINT_INIT;
+    bigint z1 = BIGINT_INIT;
+    bigint z2 = BIGINT_INIT;
+
+    if(a->size < b->size) {
+        t = a;
+        a = b;
+        b = t;
+    }
+
+    a0.limit = a1.limit = b0.limit = b1.limit = z1.limit = z2.limit = c->limit;
+
+    m = (a->size + 1) / 2;
+
+    if( (r = bigint_slice(&a0, a, 0, m)) != 0) goto cleanup;
+    if( (r = bigint_slice(&a1, a, m, a->size - m)) != 0) goto cleanup;
+
+    if(b->size <= m) {
+        /* unbalanced, b fits entirely in the low half:
+         * a * b = (a1 * b) * B^m + a0 * b */
+        if( (r = bigint_mul_unsigned(c, &a0, b)) != 0) goto cleanup;
+        if( (r = bigint_mul_unsigned(&z1, &a1, b)) != 0) goto cleanup;
+        if( (r = bigint_add_shifted_unsigned(c, &z1, m)) != 0) goto cleanup;
+    } else {
+        /* when squaring, the b pieces are the a pieces, so each
+         * of the three products below is a square as well */
+        y0 = &a0;
+        y1 = &a1;
+        if(a != b) {
+            if( (r = bigint_slice(&b0, b, 0, m)) != 0) goto cleanup;
+            if( (r = bigint_slice(&b1, b, m, b->size - m)) != 0) goto cleanup;
+            y0 = &b0;
+            y1 = &b1;
+        }
+
+        if( (r = bigint_mul_unsigned(c, &a0, y0)) != 0) goto cleanup;
+        if( (r = bigint_mul_unsigned(&z2, &a1, y1)) != 0) goto cleanup;
+
+        /* a0 and b0 are no longer needed, re-use them for the sums */
+        if( (r = bigint_add_unsigned(&a0, &a1)) != 0) goto cleanup;
+        if(a != b) {
+            if( (r = bigint_add_unsigned(&b0, &b1)) != 0) goto cleanup;
+        }
+        if( (r = bigint_mul_unsigned(&z1, &a0, y0)) != 0) goto cleanup;
+        if( (r = bigint_sub_unsigned(&z1, c)) != 0) goto cleanup;
+        if( (r = bigint_sub_unsigned(&z1, &z2)) != 0) goto cleanup;
+
+        if( (r = bigint_add_shifted_unsigned(c, &z1, m)) != 0) goto cleanup;
+        if( (r = bigint_add_shifted_unsigned(c, &z2, 2 * m)) != 0) goto cleanup;
+    }
+
+    c->sign = a->sign ^ b->sign;
+    bigint_truncate(c);
+
+    cleanup:
+    bigint_free(&a0);
+    bigint_free(&a1);
+    bigint_free(&b0);
+    bigint_free(&b1);
+    bigint_free(&z1);
+    bigint_free(&z2);
+    return r;
+}
+
+/* evaluates the 3-piece polynomial x2 * X^2 + x1 * X + x0 at
+ * X = 1, X = -1 and X = -2 */
+static
+int bigint_toom3_eval(bigint* p1, bigint* pm1, bigint* pm2, const bigint* x0, const bigint* x1, const bigint* x2) {
+    int r;
+
+    /* p1 = x0 + x2, shared by p1 and pm1 */
+    if( (r = bigint_copy(p1, x0)) != 0) return r;
+    if( (r = bigint_add_unsigned(p1, x2)) != 0) return r;
+
+    /* pm1 = x0 + x2 - x1 */
+    if( (r = bigint_copy(pm1, p1)) != 0) return r;
+    if( (r = bigint_acc_signed(pm1, x1, 1)) != 0) return r;
+
+    /* p1 = x0 + x1 + x2 */
+    if( (r = bigint_add_unsigned(p1, x1)) != 0) return r;
+
+    /* pm2 = (pm1 + x2) * 2 - x0 = 4*x2 - 2*x1 + x0 */
+    if( (r = bigint_copy(pm2, pm1)) != 0) return r;
+    if( (r = bigint_acc_signed(pm2, x2, 0)) != 0) return r;
+    if( (r = bigint_lshift_overwrite(pm2, 1)) != 0) return r;
+    return bigint_acc_signed(pm2, x0, 1);
+}
+
+/* Toom-Cook 3-way multiplication, splitting both operands into three
+ * pieces of k words and treating them as polynomials in X = B^k:
+ *   a = a2 * X^2 + a1 * X + a0
+ *   b = b2 * X^2 + b1 * X + b0
+ *
+ * the product polynomial has 5 coefficients, which are recovered from
+ * the pointwise products at X = 0, 1, -1, -2 and infinity using
+ * Bodrato's interpolation sequence. The intermediate values can be
+ * negative, so those use the sign field, while the final coefficients
+ * are always non-negative.
+ *
+ * c must not alias a or b. All operand pieces must be non-empty, ie
+ * both operands need more than 2k words */
+static
+int bigint_mul_toom3(bigint* c, const bigint* a, const bigint* b) {
+    int r;
+    size_t k;
+    bigint a0 = BIGINT_INIT;
+    bigint a1 = BIGINT_INIT;
+    bigint a2 = BIGINT_INIT;
+    bigint b0 = BIGINT_INIT;
+    bigint b1 = BIGINT_INIT;
+    bigint b2 = BIGINT_INIT;
+    bigint p1 = BIGINT_INIT;
+    bigint pm1 = BIGINT_INIT;
+    bigint pm2 = BIGINT_INIT;
+    bigint q1 = BIGINT_INIT;
+    bigint qm1 = BIGINT_INIT;
+    bigint qm2 = BIGINT_INIT;
+    bigint r1 = BIGINT_INIT;
+    bigint r2 = BIGINT_INIT;
+    bigint r3 = BIGINT_INIT;
+    bigint rinf = BIGINT_INIT;
+
+    a0.limit = a1.limit = a2.limit = c->limit;
+    b0.limit = b1.limit = b2.limit = c->limit;
+    p1.limit = pm1.limit = pm2.limit = c->limit;
+    q1.limit = qm1.limit = qm2.limit = c->limit;
+    r1.limit = r2.limit = r3.limit = rinf.limit = c->limit;
+
+    k = ((a->size > b->size ? a->size : b->size) + 2) / 3;
+
+    if( (r = bigint_slice(&a0, a, 0, k)) != 0) goto cleanup;
+    if( (r = bigint_slice(&a1, a, k, k)) != 0) goto cleanup;
+    if( (r = bigint_slice(&a2, a, 2 * k, a->size - 2 * k)) != 0) goto cleanup;
+    if( (r = bigint_toom3_eval(&p1, &pm1, &pm2, &a0, &a1, &a2)) != 0) goto cleanup;
+
+    if(a == b) {
+        /* squaring, every pointwise product is a square */
+        if( (r = bigint_mul_unsigned(c, &a0, &a0)) != 0) goto cleanup;
+        if( (r = bigint_mul_unsigned(&r1, &p1, &p1)) != 0) goto cleanup;
+        if( (r = bigint_mul_unsigned(&r2, &pm1, &pm1)) != 0) goto cleanup;
+        if( (r = bigint_mul_unsigned(&r3, &pm2, &pm2)) != 0) goto cleanup;
+        if( (r = bigint_mul_unsigned(&rinf, &a2, &a2)) != 0) goto cleanup;
+    } else {
+        if( (r = bigint_slice(&b0, b, 0, k)) != 0) goto cleanup;
+        if( (r = bigint_slice(&b1, b, k, k)) != 0) goto cleanup;
+        if( (r = bigint_slice(&b2, b, 2 * k, b->size - 2 * k)) != 0) goto cleanup;
+
+        if( (r = bigint_toom3_eval(&q1, &qm1, &qm2, &b0, &b1, &b2)) != 0) goto cleanup;
+
+        /* pointwise products, r0 goes straight into c */
+        if( (r = bigint_mul_unsigned(c, &a0, &b0)) != 0) goto cleanup;
+        if( (r = bigint_mul_unsigned(&r1, &p1, &q1)) != 0) goto cleanup;
+        if( (r = bigint_mul_unsigned(&r2, &pm1, &qm1)) != 0) goto cleanup;
+        if( (r = bigint_mul_unsigned(&r3, &pm2, &qm2)) != 0) goto cleanup;
+        if( (r = bigint_mul_unsigned(&rinf, &a2, &b2)) != 0) goto cleanup;
+    }
+
+    /* r3 = (r(-2) - r(1)) / 3 */
+    if( (r = bigint_acc_signed(&r3, &r1, 1)) != 0) goto cleanup;
+    bigint_divexact_word(&r3, 3);
+
+    /* r1 = (r(1) - r(-1)) / 2 */
+    if( (r = bigint_acc_signed(&r1, &r2, 1)) != 0) goto cleanup;
+    if( (r = bigint_rshift_overwrite(&r1, 1)) != 0) goto cleanup;
+
+    /* r2 = r(-1) - r(0) */
+    if( (r = bigint_acc_signed(&r2, c, 1)) != 0) goto cleanup;
+
+    /* r3 = (r2 - r3) / 2 + 2 * r(inf) */
+    if( (r = bigint_acc_signed(&r3, &r2, 1)) != 0) goto cleanup;
+    r3.sign = r3.size ? !r3.sign : 0;
+    if( (r = bigint_rshift_overwrite(&r3, 1)) != 0) goto cleanup;
+    if( (r = bigint_acc_signed(&r3, &rinf, 0)) != 0) goto cleanup;
+    if( (r = bigint_acc_signed(&r3, &rinf, 0)) != 0) goto cleanup;
+
+    /* r2 = r2 + r1 - r(inf) */
+    if( (r = bigint_acc_signed(&r2, &r1, 0)) != 0) goto cleanup;
+    if( (r = bigint_acc_signed(&r2, &rinf, 1)) != 0) goto cleanup;
+
+    /* r1 = r1 - r3 */
+    if( (r = bigint_acc_signed(&r1, &r3, 1)) != 0) goto cleanup;
+
+    assert(!r1.sign && !r2.sign && !r3.sign);
+
+    if( (r = bigint_add_shifted_unsigned(c, &r1, k)) != 0) goto cleanup;
+    if( (r = bigint_add_shifted_unsigned(c, &r2, 2 * k)) != 0) goto cleanup;
+    if( (r = bigint_add_shifted_unsigned(c, &r3, 3 * k)) != 0) goto cleanup;
+    if( (r = bigint_add_shifted_unsigned(c, &rinf, 4 * k)) != 0) goto cleanup;
+
+    c->sign = a->sign ^ b->sign;
+    bigint_truncate(c);
+
+    cleanup:
+    bigint_free(&a0);
+    bigint_free(&a1);
+    bigint_free(&a2);
+    bigint_free(&b0);
+    bigint_free(&b1);
+    bigint_free(&b2);
+    bigint_free(&p1);
+    bigint_free(&pm1);
+    bigint_free(&pm2);
+    bigint_free(&q1);
+    bigint_free(&qm1);
+    bigint_free(&qm2);
+    bigint_free(&r1);
+    bigint_free(&r2);
+    bigint_free(&r3);
+    bigint_free(&rinf);
+    return r;
+}
+
+#ifndef BIGINT_NO_MALLOC
+/* the NTT works on 16-bit digits modulo two primes of the form
+ * k * 2^s + 1, and recombines them with the chinese remainder theorem.
+ * Each convolution term is below 2^24 * (2^16-1)^2 < p1 * p2, so two
+ * primes are enough, and the longest transform either prime supports
+ * is 2^24 points, ie a product of up to 2^28 bits. */
+#define BIGINT_NTT_DIGIT_BIT 16
+#define BIGINT_NTT_DIGIT_MASK 0xFFFF
+#define BIGINT_NTT_MAX_LENGTH ((size_t)1 << 24)
+
+static const uint32_t bigint_ntt_primes[2] = { 754974721, 469762049 }; /* 45 * 2^24 + 1, 7 * 2^26 + 1 */
+static const uint32_t bigint_ntt_roots[2]  = { 11, 3 }; /* primitive roots of the above */
+
+/* all arithmetic modulo p is done in Montgomery form, with R = 2^32 */
+typedef struct bigint_ntt_mod {
+    uint32_t p;
+    uint32_t pinv; /* -p^-1 mod 2^32 */
+    uint32_t one;  /* R mod p, ie 1 in Montgomery form */
+    uint32_t r2;   /* R^2 mod p, used to convert into Montgomery form */
+} bigint_ntt_mod;
+
+static void bigint_ntt_mod_init(bigint_ntt_mod* m, uint32_t p) {
+    uint32_t inv = p; /* correct to 3 bits, each step doubles that */
+    inv *= 2 - p * inv;
+    inv *= 2 - p * inv;
+    inv *= 2 - p * inv;
+    inv *= 2 - p * inv;
+
+    m->p = p;
+    m->pinv = (uint32_t)0 - inv;
+    m->one = (uint32_t)((((uint64_t)1) << 32) % p);
+    m->r2 = (uint32_t)(((uint64_t)m->one * m->one) % p);
+}
+
+/* returns a * b / R mod p */
+static inline uint32_t bigint_ntt_mul(uint32_t a, uint32_t b, const bigint_ntt_mod* m) {
+    uint64_t t = (uint64_t)a * b;
+    uint32_t q = (uint32_t)t * m->pinv;
+    uint32_t r = (uint32_t)((t + (uint64_t)q * m->p) >> 32);
+    return r >= m->p ? r - m->p : r;
+}
+
+static uint32_t bigint_ntt_pow(uint32_t a, uint32_t e, const bigint_ntt_mod* m) {
+    uint32_t r = m->one;
+    while(e) {
+        if(e & 1) r = bigint_ntt_mul(r, a, m);
+        a = bigint_ntt_mul(a, a, m);
+        e >>= 1;
+    }
+    return r;
+}
+
+static inline size_t bigint_ntt_digits(const bigint* a) {
+    return (bigint_bitlength(a) + BIGINT_NTT_DIGIT_BIT - 1) / BIGINT_NTT_DIGIT_BIT;
+}
+
+static inline uint32_t bigint_ntt_get_digit(const bigint* a, size_t i) {
+#if BIGINT_WORD_WIDTH == 1
+    uint32_t d = a->words[2 * i];
+    if(2 * i + 1 < a->size) d |= ((uint32_t)a->words[2 * i + 1]) << 8;
+    return d;
+#else
+    size_t bit = i * BIGINT_NTT_DIGIT_BIT;
+    return (uint32_t)(a->words[bit / BIGINT_WORD_BIT] >> (bit % BIGINT_WORD_BIT)) & BIGINT_NTT_DIGIT_MASK;
+#endif
+}
+
+/* c must have been cleared beforehand */
+static inline void bigint_ntt_set_digit(bigint* c, size_t i, uint32_t d) {
+#if BIGINT_WORD_WIDTH == 1
+    c->words[2 * i] = (bigint_word)(d & 0xFF);
+    if(2 * i + 1 < c->size) c->words[2 * i + 1] = (bigint_word)(d >> 8);
+#else
+    size_t bit = i * BIGINT_NTT_DIGIT_BIT;
+    c->words[bit / BIGINT_WORD_BIT] |= ((bigint_word)d) << (bit % BIGINT_WORD_BIT);
+#endif
+}
+
+/* loads the digits of a into x (in Montgomery form), zero-padded to n */
+static void bigint_ntt_load(uint32_t* x, size_t n, const bigint* a, const bigint_ntt_mod* m) {
+    size_t i;
+    size_t d = bigint_ntt_digits(a);
+
+    for(i = 0; i < d; i++) {
+        x[i] = bigint_ntt_mul(bigint_ntt_get_digit(a, i), m->r2, m);
+    }
+    for(; i < n; i++) {
+        x[i] = 0;
+    }
+}
+
+/* twiddle table layout: for every stage with half-length h, the h
+ * powers of a primitive (2h)-th root of unity live at tw[h .. 2h-1] */
+static void bigint_ntt_twiddles(uint32_t* tw, size_t n, uint32_t root, const bigint_ntt_mod* m) {
+    size_t h, k;
+
+    /* the largest stage uses root itself, each smaller stage uses
+     * every other entry of the stage above it */
+    h = n >> 1;
+    if(h == 0) return;
+    tw[h] = m->one;
+    for(k = 1; k < h; k++) {
+        tw[h + k] = bigint_ntt_mul(tw[h + k - 1], root, m);
+    }
+    while(h > 1) {
+        h >>= 1;
+        for(k = 0; k < h; k++) {
+            tw[h + k] = tw[2 * h + 2 * k];
+        }
+    }
+}
+
+/* in-place decimation-in-frequency transform, leaves the output
+ * in bit-reversed order */
+static void bigint_ntt_forward(uint32_t* x, size_t n, const uint32_t* tw, const bigint_ntt_mod* m) {
+    size_t i, k, h;
+    uint32_t u, v;
+
+    for(h = n >> 1; h > 0; h >>= 1) {
+        for(i = 0; i < n; i += 2 * h) {
+            for(k = 0; k < h; k++) {
+                u = x[i + k];
+                v = x[i + k + h];
+                x[i + k] = u + v >= m->p ? u + v - m->p : u + v;
+                x[i + k + h] = bigint_ntt_mul(u >= v ? u - v : u + m->p - v, tw[h + k], m);
+            }
+        }
+    }
+}
+
+/* in-place decimation-in-time inverse transform, takes bit-reversed
+ * input from bigint_ntt_forward and leaves the output in natural order,
+ * not yet scaled by 1/n. The inverse root powers are w^-k = -w^(2h-k) */
+static void bigint_ntt_inverse(uint32_t* x, size_t n, const uint32_t* tw, const bigint_ntt_mod* m) {
+    size_t i, k, h;
+    uint32_t u, v;
+
+    for(h = 1; h < n; h <<= 1) {
+        for(i = 0; i < n; i += 2 * h) {
+            u = x[i];
+            v = x[i + h];
+            x[i] = u + v >= m->p ? u + v - m->p : u + v;
+            x[i + h] = u >= v ? u - v : u + m->p - v;
+            for(k = 1; k < h; k++) {
+                u = x[i + k];
+                v = bigint_ntt_mul(x[i + k + h], tw[2 * h - k], m);
+                x[i + k] = u >= v ? u - v : u + m->p - v;
+                x[i + k + h] = u + v >= m->p ? u + v - m->p : u + v;
+            }
+        }
+    }
+}
+
+static inline int bigint_ntt_fits(const bigint* a, const bigint* b) {
+    return bigint_ntt_digits(a) + bigint_ntt_digits(b) <= BIGINT_NTT_MAX_LENGTH;
+}
+
+/* multiplies via a number-theoretic transform modulo each prime and
+ * recombines the two convolutions with the chinese remainder theorem.
+ * c must not alias a or b, and the product must fit bigint_ntt_fits */
+static
+int bigint_mul_ntt(bigint* c, const bigint* a, const bigint* b) {
+    int r;
+    size_t i, n, da, db, nd;
+    uint32_t* buf;
+    uint32_t* x;
+    uint32_t* y;
+    uint32_t* tw;
+    uint32_t t, x1, x2, ninv, p1inv;
+    uint64_t carry;
+    bigint_ntt_mod m;
+    unsigned int pi;
+
+    da = bigint_ntt_digits(a);
+    db = bigint_ntt_digits(b);
+    if(da == 0 || db == 0) {
+        c->size = 0;
+        c->sign = 0;
+        return 0;
+    }
+    assert(bigint_ntt_fits(a,b));
+
+    nd = da + db;
+    n = 1;
+    while(n < nd - 1) n <<= 1;
+
+    if( (r = bigint_resize_uninit(c, (nd * BIGINT_NTT_DIGIT_BIT + BIGINT_WORD_BIT - 1) / BIGINT_WORD_BIT)) != 0) return r;
+    memset(c->words, 0, c->size * BIGINT_WORD_SIZE);
+
+    /* two result convolutions, one scratch operand and the twiddles */
+    buf = (uint32_t*)bigint_mem_alloc(4 * n * sizeof(uint32_t));
+    if(buf == NULL) return BIGINT_ENOMEM;
+    y = &buf[2 * n];
+    tw = &buf[3 * n];
+
+    for(pi = 0; pi < 2; pi++) {
+        bigint_ntt_mod_init(&m, bigint_ntt_primes[pi]);
+        x = &buf[pi * n];
+
+        t = bigint_ntt_pow(bigint_ntt_mul(bigint_ntt_roots[pi], m.r2, &m), (m.p - 1) / (uint32_t)n, &m);
+        bigint_ntt_twiddles(tw, n, t, &m);
+
+        bigint_ntt_load(x, n, a, &m);
+        bigint_ntt_forward(x, n, tw, &m);
+        if(a == b) {
+            /* squaring only needs the one transform */
+            for(i = 0; i < n; i++) {
+                x[i] = bigint_ntt_mul(x[i], x[i], &m);
+            }
+        } else {
+            bigint_ntt_load(y, n, b, &m);
+            bigint_ntt_forward(y, n, tw, &m);
+            for(i = 0; i < n; i++) {
+                x[i] = bigint_ntt_mul(x[i], y[i], &m);
+            }
+        }
+        bigint_ntt_inverse(x, n, tw, &m);
+
+        /* multiplying by the plain (not Montgomery) 1/n both scales
+         * and converts out of Montgomery form */
+        ninv = bigint_ntt_mul(bigint_ntt_pow(bigint_ntt_mul((uint32_t)n, m.r2, &m), m.p - 2, &m), 1, &m);
+        for(i = 0; i < n; i++) {
+            x[i] = bigint_ntt_mul(x[i], ninv, &m);
+        }
+    }
+
+    /* m is still set up for the second prime, find p1^-1 mod p2 in
+     * Montgomery form so multiplying by it gives a plain result */
+    p1inv = bigint_ntt_pow(bigint_ntt_mul(bigint_ntt_primes[0] % m.p, m.r2, &m), m.p - 2, &m);
+
+    carry = 0;
+    for(i = 0; i < nd; i++) {
+        if(i < n) {
+            x1 = buf[i];
+            x2 = buf[n + i];
+            t = x1 >= m.p ? x1 - m.p : x1;
+            t = x2 >= t ? x2 - t : x2 + m.p - t;
+            t = bigint_ntt_mul(t, p1inv, &m);
+            carry += x1 + ((uint64_t)bigint_ntt_primes[0]) * t;
+        }
+        bigint_ntt_set_digit(c, i, (uint32_t)(carry & BIGINT_NTT_DIGIT_MASK));
+        carry >>= BIGINT_NTT_DIGIT_BIT;
+    }
+    assert(carry == 0);
+
+    bigint_mem_free(buf, 4 * n * sizeof(uint32_t));
+
+    c->sign = a->sign ^ b->sign;
+    bigint_truncate(c);
+    return 0;
+}
+#endif
+
+/* picks a multiplication algorithm based on the operand sizes,
+ * c must not alias a or b */
+static
+int bigint_mul_unsigned(bigint* c, const bigint* a, const bigint* b) {
+    size_t max_size, min_size;
+
+    if(a == b) return bigint_sqr_unsigned(c, a);
+
+    max_size = a->size > b->size ? a->size : b->size;
+    min_size = a->size > b->size ? b->size : a->size;
+
+#ifndef BIGINT_NO_MALLOC
+    if(min_size >= BIGINT_NTT_THRESHOLD && bigint_ntt_fits(a, b)) {
+        return bigint_mul_ntt(c, a, b);
+    }
+#endif
+    /* Toom-3 needs all three pieces of the shorter operand, anything
+     * more unbalanced is split up by the Karatsuba path first */
+    if(min_size >= BIGINT_TOOM3_THRESHOLD && min_size > 2 * ((max_size + 2) / 3)) {
+        return bigint_mul_toom3(c, a, b);
+    }
+    if(min_size >= BIGINT_KARATSUBA_THRESHOLD) {
+        return bigint_mul_karatsuba(c, a, b);
+    }
+    return bigint_mul_long(c, a, b);
+}
+
+/* picks a squaring algorithm, the multiplication kernels all
+ * notice when both operands are the same and square their pieces,
+ * c must not alias a */
+static
+int bigint_sqr_unsigned(bigint* c, const bigint* a) {
+#ifndef BIGINT_NO_MALLOC
+    if(a->size >= BIGINT_NTT_THRESHOLD && bigint_ntt_fits(a, a)) {
+        return bigint_mul_ntt(c, a, a);
+    }
+#endif
+    if(a->size >= BIGINT_TOOM3_THRESHOLD) {
+        return bigint_mul_toom3(c, a, a);
+    }
+    if(a->size >= BIGINT_KARATSUBA_THRESHOLD) {
+        return bigint_mul_karatsuba(c, a, a);
+    }
+    return bigint_sqr_long(c, a);
+}
+
+static int bigint_mul_word(bigint* a, bigint_word val) {
+    int r;
+    size_t i = 0;
+    bigint_word carry = 0;
+    bigint_word c = 0;
+
+    if(!val) {
+        a->size = 0;
+        a->sign = 0;
+        return 0;
+    }
+
+    carry = 0;
+    for(i=0;i<a->size;i++) {
+        c = bigint_word_mul(&a->words[i],val);
+        c += bigint_word_add(&a->words[i],carry);
+        carry = c;
+    }
+    if(carry) {
+        if( (r = bigint_append(a, carry)) != 0) return r;
+    }
+
+    bigint_truncate(a);
+    return 0;
+}
+
+/* performs a = a * mul + add in a single pass */
+static int bigint_mul_add_word(bigint* a, bigint_word mul, bigint_word add) {
+    int r;
+    size_t i;
+    bigint_word carry = add;
+    bigint_word c;
+
+    for(i=0;i<a->size;i++) {
+        c = bigint_word_mul(&a->words[i],mul);
+        c += bigint_word_add(&a->words[i],carry);
+        carry = c;
+    }
+    if(carry) {
+        if( (r = bigint_append(a, carry)) != 0) return r;
+    }
+
+    bigint_truncate(a);
+    return 0;
+}
+
+#define BIGINT_MUL_CONST(x) \
+static inline int bigint_mul_const_ ## x (bigint* a) { \
+    int r; \
+    size_t i = 0; \
+    bigint_word carry = 0; \
+    bigint_word c = 0; \
+    for(i=0;i<a->size;i++) { \
+        c = bigint_word_mul_const_ ## x (&a->words[i]); \
+        c += bigint_word_add(&a->words[i],carry); \
+        carry = c; \
     } \
     if(carry) { \
         if( (r = bigint_append(a, carry)) != 0) return r; \
@@ -894,123 +2079,272 @@ static inline int bigint_mul_const_ ## x (bigint* a) { \
 
 BIGINT_MUL_CONST(10)
 
+/* the number of digits of base that fit in a word, and that power of base */
+static size_t bigint_word_chunk(unsigned int base, bigint_word* pow) {
+    size_t digits = 1;
+    bigint_word p = (bigint_word)base;
+
+    while(p <= (bigint_word)-1 / base) {
+        p = (bigint_word)(p * base);
+        digits++;
+    }
+    *pow = p;
+    return digits;
+}
+
+/* value of a digit in 0-9, a-z (either case), 36 for anything else */
+static unsigned int bigint_digit_value(char c) {
+    if(c >= '0' && c <= '9') return (unsigned int)(c - '0');
+    if(c >= 'a' && c <= 'z') return (unsigned int)(c - 'a') + 10;
+    if(c >= 'A' && c <= 'Z') return (unsigned int)(c - 'A') + 10;
+    return 36;
+}
+
+/* parses digits of a base 2^bits, each digit is a fixed run of bits so
+ * the result is sized once and filled in from the end of the string */
+static int bigint_from_string_pow2(bigint* b, const char* str, size_t len, unsigned int bits) {
+    size_t i = 0;
+    size_t bit = 0;
+    size_t words;
+    size_t w;
+    unsigned int shift;
+    unsigned int digit;
+    int r;
+
+    while(i < len && str[i]) i++;
+    len = i;
+
+    /* leading zeros don't count against the limit */
+    while(len > 1 && str[0] == '0') {
+        str++;
+        len--;
+    }
+
+    words = len / BIGINT_WORD_BIT * bits
+      + ((len % BIGINT_WORD_BIT) * bits + BIGINT_WORD_BIT - 1) / BIGINT_WORD_BIT;
+    bigint_reset(b);
+    if( (r = bigint_resize(b, words)) != 0) return r;
+
+    while(len--) {
+        digit = bigint_digit_value(str[len]);
+        if(digit >> bits) return BIGINT_EINVAL;
+
+        w = bit / BIGINT_WORD_BIT;
+        shift = (unsigned int)(bit % BIGINT_WORD_BIT);
+        b->words[w] |= (bigint_word)((bigint_word)digit << shift);
+        if(shift + bits > BIGINT_WORD_BIT && w + 1 < words) {
+            b->words[w+1] |= (bigint_word)(digit >> (BIGINT_WORD_BIT - shift));
+        }
+        bit += bits;
+    }
+
+    bigint_truncate(b);
+    return 0;
+}
+
 /* does NOT accept a string with a leading 0x - that's handled in
  * bigint_from_string. does NOT parse a leading +/-, also handled
  * in bigint_from_string */
 static int bigint_from_string_base16(bigint* b, const char* str, size_t len) {
+    return bigint_from_string_pow2(b, str, len, 4);
+}
+
+/* b must be zero, str has exactly len characters */
+static int bigint_from_string_base10_chunked(bigint* b, const char* str, size_t len) {
     bigint_word word;
-    size_t i = 0;
+    size_t i;
+    size_t end;
     int r;
 
-    while(i < len && str[i]) {
-        if( (r = bigint_lshift_overwrite(b,4)) != 0) return r;
-        switch(str[i]) {
-            case '0': word = 0; break;
-            case '1': word = 1; break;
-            case '2': word = 2; break;
-            case '3': word = 3; break;
-            case '4': word = 4; break;
-            case '5': word = 5; break;
-            case '6': word = 6; break;
-            case '7': word = 7; break;
-            case '8': word = 8; break;
-            case '9': word = 9; break;
-            case 'A': word = 10; break;
-            case 'a': word = 10; break;
-            case 'B': word = 11; break;
-            case 'b': word = 11; break;
-            case 'C': word = 12; break;
-            case 'c': word = 12; break;
-            case 'D': word = 13; break;
-            case 'd': word = 13; break;
-            case 'E': word = 14; break;
-            case 'e': word = 14; break;
-            case 'F': word = 15; break;
-            case 'f': word = 15; break;
-            default: return BIGINT_EINVAL;
-        }
-        if( (r = bigint_add_word(b,word)) != 0) return r;
-        i++;
+    /* BIGINT_WORD_DIGITS10 digits go into a word at a time, the first
+     * chunk takes whatever is left over so the rest are all full */
+    i = 0;
+    end = len % BIGINT_WORD_DIGITS10;
+    if(end == 0) end = BIGINT_WORD_DIGITS10;
+
+    while(i < len) {
+        word = 0;
+        while(i < end) {
+            if(str[i] < '0' || str[i] > '9') return BIGINT_EINVAL;
+            word = (bigint_word)(word * 10 + (bigint_word)(str[i] - '0'));
+            i++;
+        }
+        if( (r = bigint_mul_add_word(b,BIGINT_WORD_POW10,word)) != 0) return r;
+        end += BIGINT_WORD_DIGITS10;
     }
 
     return 0;
 }
 
-/* does NOT parse a leading +/-, handled in bigint_from_string */
-static int bigint_from_string_base10(bigint* b, const char* str, size_t len) {
-    bigint_word word;
-    size_t i = 0;
+#ifndef BIGINT_NO_MALLOC
+BIGINT_API
+void bigint_pow10_cache_init(bigint_pow10_cache* c) {
+    size_t j;
+    for(j = 0; j < sizeof(c->pow) / sizeof(c->pow[0]); j++) bigint_init(&c->pow[j]);
+    c->count = 0;
+}
+
+BIGINT_API
+void bigint_pow10_cache_free(bigint_pow10_cache* c) {
+    size_t j;
+    for(j = 0; j < sizeof(c->pow) / sizeof(c->pow[0]); j++) bigint_free(&c->pow[j]);
+    c->count = 0;
+}
+
+/* builds whatever c is missing of pow[0..k], new entries get limit */
+static int bigint_pow10_cache_build(bigint_pow10_cache* c, size_t k, size_t limit) {
+    size_t i;
+    size_t j;
     int r;
 
-    while(i < len && str[i]) {
-        if( (r = bigint_mul_const_10(b)) != 0) return r;
-        switch(str[i]) {
-            case '0': word = 0; break;
-            case '1': word = 1; break;
-            case '2': word = 2; break;
-            case '3': word = 3; break;
-            case '4': word = 4; break;
-            case '5': word = 5; break;
-            case '6': word = 6; break;
-            case '7': word = 7; break;
-            case '8': word = 8; break;
-            case '9': word = 9; break;
-            default: return BIGINT_EINVAL;
-        }
-        if( (r = bigint_add_word(b,word)) != 0) return r;
-        i++;
+    while(c->count <= k) {
+        j = c->count;
+        c->pow[j].limit = limit;
+        if(j == 0) {
+            if( (r = bigint_from_word(&c->pow[0], 1)) != 0) return r;
+            for(i = 0; i < BIGINT_STRING_DC_THRESHOLD; i++) {
+                if( (r = bigint_mul_add_word(&c->pow[0], BIGINT_WORD_POW10, 0)) != 0) return r;
+            }
+        } else {
+            if( (r = bigint_sqr_unsigned(&c->pow[j], &c->pow[j-1])) != 0) return r;
+        }
+        c->count++;
     }
-
     return 0;
 }
 
-/* does NOT parse a leading +/-, handled in bigint_from_string */
-static int bigint_from_string_base8(bigint* b, const char* str, size_t len) {
-    bigint_word word;
-    size_t i = 0;
+/* splits str so the low part has BIGINT_STRING_DC_DIGITS << k digits
+ * for the largest k that leaves something in the high part, the
+ * halves are parsed recursively and joined with pow[k], which is
+ * 10^(BIGINT_STRING_DC_DIGITS << k). b must be zero */
+static int bigint_from_string_base10_dc(bigint* b, const char* str, size_t len, const bigint* pow, size_t k) {
+    bigint hi = BIGINT_INIT;
+    bigint lo = BIGINT_INIT;
+    size_t digits;
     int r;
 
-    while(i < len && str[i]) {
-        if( (r = bigint_lshift_overwrite(b,3)) != 0) return r;
-        switch(str[i]) {
-            case '0': word = 0; break;
-            case '1': word = 1; break;
-            case '2': word = 2; break;
-            case '3': word = 3; break;
-            case '4': word = 4; break;
-            case '5': word = 5; break;
-            case '6': word = 6; break;
-            case '7': word = 7; break;
-            default: return BIGINT_EINVAL;
-        }
-        if( (r = bigint_add_word(b,word)) != 0) return r;
-        i++;
+    if(len <= BIGINT_STRING_DC_DIGITS) {
+        return bigint_from_string_base10_chunked(b, str, len);
     }
 
-    return 0;
+    while( (digits = (size_t)BIGINT_STRING_DC_DIGITS << k) >= len) k--;
+
+    hi.limit = b->limit;
+    lo.limit = b->limit;
+
+    if( (r = bigint_from_string_base10_dc(&hi, str, len - digits, pow, k)) != 0) goto cleanup;
+    if( (r = bigint_from_string_base10_dc(&lo, str + len - digits, digits, pow, k)) != 0) goto cleanup;
+    if( (r = bigint_mul_unsigned(b, &hi, &pow[k])) != 0) goto cleanup;
+    r = bigint_add_unsigned(b, &lo);
+
+    cleanup:
+    bigint_free(&hi);
+    bigint_free(&lo);
+    return r;
 }
+#endif
 
-/* does NOT parse a leading +/-, handled in bigint_from_string */
-static int bigint_from_string_base2(bigint* b, const char* str, size_t len) {
+/* does NOT parse a leading +/-, handled in bigint_from_string. The
+ * powers of ten come from c, or a cache of its own if c is NULL */
+static int bigint_from_string_base10(bigint* b, const char* str, size_t len, bigint_pow10_cache* c) {
+#ifndef BIGINT_NO_MALLOC
+    bigint_pow10_cache local;
+    size_t limit;
+    size_t k = 0;
+    int r;
+#endif
+    size_t i = 0;
+
+    while(i < len && str[i]) i++;
+    len = i;
+
+#ifdef BIGINT_NO_MALLOC
+    (void)c;
+    return bigint_from_string_base10_chunked(b, str, len);
+#else
+    while(len > 1 && str[0] == '0') {
+        str++;
+        len--;
+    }
+
+    if(len < 2 * BIGINT_STRING_DC_DIGITS) {
+        return bigint_from_string_base10_chunked(b, str, len);
+    }
+
+    /* the value is at least 10^(len-1), more than 3 bits a digit, so
+     * give up before doing any work if it can't fit */
+    if((len - 1) / 3 > b->limit) return BIGINT_ELIMIT;
+
+    while(((size_t)BIGINT_STRING_DC_DIGITS << (k + 1)) < len) k++;
+
+    /* temporaries get a little over 4 bits a digit, b's own limit is
+     * checked once the result is known */
+    limit = b->limit;
+    b->limit = len / 2 + 4 * BIGINT_BLOCK_SIZE * BIGINT_WORD_SIZE;
+
+    if(c == NULL) {
+        bigint_pow10_cache_init(&local);
+        c = &local;
+    }
+    if( (r = bigint_pow10_cache_build(c, k, b->limit)) != 0) goto cleanup;
+
+    r = bigint_from_string_base10_dc(b, str, len, c->pow, k);
+    /* same rounding as bigint_resize */
+    if(r == 0 && ((b->size + BIGINT_BLOCK_SIZE-1) & -BIGINT_BLOCK_SIZE) * BIGINT_WORD_SIZE > limit) {
+        r = BIGINT_ELIMIT;
+    }
+
+    cleanup:
+    b->limit = limit;
+    if(c == &local) bigint_pow10_cache_free(&local);
+    return r;
+#endif
+}
+
+/* any base from 2 to 36 the same way as base 10, a word-sized chunk
+ * of digits at a time. b must be zero */
+static int bigint_from_string_base(bigint* b, const char* str, size_t len, unsigned int base) {
+    bigint_word pow;
     bigint_word word;
+    unsigned int digit;
+    size_t digits = bigint_word_chunk(base, &pow);
     size_t i = 0;
+    size_t end;
     int r;
 
-    while(i < len && str[i]) {
-        if( (r = bigint_lshift_overwrite(b,1)) != 0) return r;
-        switch(str[i]) {
-            case '0': word = 0; break;
-            case '1': word = 1; break;
-            default: return BIGINT_EINVAL;
+    while(i < len && str[i]) i++;
+    len = i;
+
+    i = 0;
+    end = len % digits;
+    if(end == 0) end = digits;
+
+    while(i < len) {
+        word = 0;
+        while(i < end) {
+            digit = bigint_digit_value(str[i]);
+            if(digit >= base) return BIGINT_EINVAL;
+            word = (bigint_word)(word * base + digit);
+            i++;
         }
-        if( (r = bigint_add_word(b,word)) != 0) return r;
-        i++;
+        if( (r = bigint_mul_add_word(b,pow,word)) != 0) return r;
+        end += digits;
     }
 
     return 0;
 }
 
-static int bigint_from_string_base0(bigint* b, const char* str, size_t len) {
+/* does NOT parse a leading +/-, handled in bigint_from_string */
+static int bigint_from_string_base8(bigint* b, const char* str, size_t len) {
+    return bigint_from_string_pow2(b, str, len, 3);
+}
+
+/* does NOT parse a leading +/-, handled in bigint_from_string */
+static int bigint_from_string_base2(bigint* b, const char* str, size_t len) {
+    return bigint_from_string_pow2(b, str, len, 1);
+}
+
+static int bigint_from_string_base0(bigint* b, const char* str, size_t len, bigint_pow10_cache* c) {
     if(str[0] == '0') {
         str++;
         len--;
@@ -1048,7 +2382,7 @@ static int bigint_from_string_base0(bigint* b, const char* str, size_t len) {
         return bigint_from_string_base2(b,str,len);
     }
 
-    return bigint_from_string_base10(b,str,len);
+    return bigint_from_string_base10(b,str,len,c);
 }
 
 /* allows strings like:
@@ -1058,10 +2392,10 @@ static int bigint_from_string_base0(bigint* b, const char* str, size_t len) {
  *  1234 (base10)
  *  x1234 (base16)
  *  0x1234 (base16)
+ * c is only used by base 10, and may be NULL
  */
-
-BIGINT_API
-int bigint_from_string(bigint* b, const char* str, size_t len, unsigned int base) {
+static
+int bigint_from_string_tmp(bigint* b, const char* str, size_t len, unsigned int base, bigint_pow10_cache* c) {
     int r = 0;
     size_t sign = 0;
 
@@ -1092,7 +2426,7 @@ int bigint_from_string(bigint* b, const char* str, size_t len, unsigned int base
         case 8: {
             r = bigint_from_string_base8(b,str,len); break;
         }
-        case 10: r = bigint_from_string_base10(b,str,len); break;
+        case 10: r = bigint_from_string_base10(b,str,len,c); break;
         case 16: {
             if(len > 1 && str[0] == 'x') {
                 str++;
@@ -1105,19 +2439,160 @@ int bigint_from_string(bigint* b, const char* str, size_t len, unsigned int base
             }
             r = bigint_from_string_base16(b,str,len); break;
         }
-        case 0: r = bigint_from_string_base0(b,str,len); break;
-        default: return BIGINT_EINVAL;
+        case 0: r = bigint_from_string_base0(b,str,len,c); break;
+        case 4: r = bigint_from_string_pow2(b,str,len,2); break;
+        case 32: r = bigint_from_string_pow2(b,str,len,5); break;
+        default: {
+            if(base < 2 || base > 36) return BIGINT_EINVAL;
+            r = bigint_from_string_base(b,str,len,base); break;
+        }
     }
     if(r == 0) {
         b->sign = sign;
     }
-    return r;
+    return r;
+}
+
+BIGINT_API
+int bigint_from_string(bigint* b, const char* str, size_t len, unsigned int base) {
+    return bigint_from_string_tmp(b,str,len,base,NULL);
+}
+
+#ifndef BIGINT_NO_MALLOC
+BIGINT_API
+int bigint_from_string_cached(bigint* b, const char* str, size_t len, unsigned int base, bigint_pow10_cache* c) {
+    return bigint_from_string_tmp(b,str,len,base,c);
+}
+#endif
+
+BIGINT_API
+int bigint_from_cstring(bigint* b, const char* str, unsigned int base) {
+    return bigint_from_string(b,str,strlen(str),base);
+}
+
+/* where byte k (0 being the least significant) of a number laid out as
+ * count words of size bytes lives, endian has to be 1 or -1 here */
+static size_t bigint_byte_offset(size_t k, size_t count, int order, size_t size, int endian) {
+    size_t w = k / size;
+    size_t j = k % size;
+
+    if(order == 1) w = count - 1 - w;
+    if(endian == 1) j = size - 1 - j;
+    return w * size + j;
+}
+
+static int bigint_host_endian(void) {
+    const uint16_t one = 1;
+    unsigned char c;
+
+    memcpy(&c, &one, 1);
+    return c ? -1 : 1;
+}
+
+static bigint_word bigint_word_bswap(bigint_word w) {
+    bigint_word r = 0;
+    size_t i;
+
+    for(i = 0; i < BIGINT_WORD_SIZE; i++) {
+        r = (bigint_word)((r << 4) << 4) | (w & 0xFF);
+        w = (bigint_word)((w >> 4) >> 4);
+    }
+    return r;
+}
+
+/* checks the layout arguments, resolves endian 0 to the host's and
+ * works out whether the bytes form a single run: -1 for least
+ * significant byte first, 1 for most significant first, 0 if not */
+static int bigint_bytes_layout(size_t count, int order, size_t size, int* endian, int* run) {
+    if(size == 0 || (order != 1 && order != -1)) return BIGINT_EINVAL;
+    if(*endian == 0) *endian = bigint_host_endian();
+    if(*endian != 1 && *endian != -1) return BIGINT_EINVAL;
+    if(count > ((size_t)-1) / size) return BIGINT_EINVAL;
+
+    if(size == 1) *run = order;
+    else if(count <= 1 || order == *endian) *run = *endian;
+    else *run = 0;
+    return 0;
+}
+
+BIGINT_API
+int bigint_import_bytes(bigint* b, size_t count, int order, size_t size, int endian, int twos_complement, const void* data) {
+    const unsigned char* p = (const unsigned char*)data;
+    size_t total;
+    size_t full = 0;
+    size_t i;
+    size_t k;
+    bigint_word w;
+    unsigned int byte;
+    unsigned int carry = 1;
+    int negative = 0;
+    int run;
+    int r;
+
+    if( (r = bigint_bytes_layout(count, order, size, &endian, &run)) != 0) return r;
+    total = count * size;
+
+    if(twos_complement && total) {
+        negative = p[bigint_byte_offset(total - 1, count, order, size, endian)] >> 7;
+    }
+
+    /* leading zeros don't count against the limit */
+    if(!negative) {
+        while(total && p[bigint_byte_offset(total - 1, count, order, size, endian)] == 0) total--;
+    }
+
+    bigint_reset(b);
+    if( (r = bigint_resize(b, (total + BIGINT_WORD_SIZE - 1) / BIGINT_WORD_SIZE)) != 0) return r;
+
+    /* whole words straight out of a single run of bytes */
+    if(run && !negative) {
+        full = total / BIGINT_WORD_SIZE;
+        for(i = 0; i < full; i++) {
+            if(run == -1) {
+                memcpy(&w, &p[i * BIGINT_WORD_SIZE], BIGINT_WORD_SIZE);
+            } else {
+                memcpy(&w, &p[count * size - (i + 1) * BIGINT_WORD_SIZE], BIGINT_WORD_SIZE);
+            }
+            if(run != bigint_host_endian()) w = bigint_word_bswap(w);
+            b->words[i] = w;
+        }
+    }
+
+    /* a two's complement negative number is negated a byte at a time */
+    for(k = full * BIGINT_WORD_SIZE; k < total; k++) {
+        byte = p[bigint_byte_offset(k, count, order, size, endian)];
+        if(negative) {
+            byte = (~byte & 0xFF) + carry;
+            carry = byte >> 8;
+            byte &= 0xFF;
+        }
+        b->words[k / BIGINT_WORD_SIZE] |= (bigint_word)((bigint_word)byte << (CHAR_BIT * (k % BIGINT_WORD_SIZE)));
+    }
+
+    bigint_truncate(b);
+    b->sign = b->size ? (size_t)negative : 0;
+    return 0;
+}
+
+#ifndef BIGINT_NO_MALLOC
+BIGINT_API
+void bigint_set_allocator(const bigint_allocator* a) {
+    if(a == NULL) {
+        bigint_allocator_hooks.alloc_fn = bigint_default_alloc;
+        bigint_allocator_hooks.realloc_fn = bigint_default_realloc;
+        bigint_allocator_hooks.free_fn = bigint_default_free;
+        bigint_allocator_hooks.user = NULL;
+        return;
+    }
+    assert(a->alloc_fn != NULL && a->free_fn != NULL);
+    bigint_allocator_hooks = *a;
 }
 
 BIGINT_API
-int bigint_from_cstring(bigint* b, const char* str, unsigned int base) {
-    return bigint_from_string(b,str,strlen(str),base);
+void bigint_get_allocator(bigint_allocator* a) {
+    *a = bigint_allocator_hooks;
 }
+#endif
 
 BIGINT_API
 void bigint_init(bigint* b) {
@@ -1129,11 +2604,49 @@ BIGINT_API
 void bigint_free(bigint* b) {
     bigint_reset(b);
 #ifndef BIGINT_NO_MALLOC
-    if(b->alloc != 0) {
-        free(b->words);
-        b->words = NULL;
-        b->alloc = 0;
-    }
+    /* a view has words but no alloc, drop the pointer without freeing it */
+#ifdef BIGINT_INLINE_WORDS
+    if(b->alloc != 0 && b->words != b->inline_words)
+#else
+    if(b->alloc != 0)
+#endif
+        bigint_mem_free(b->words,b->alloc * BIGINT_WORD_SIZE);
+    b->words = NULL;
+    b->alloc = 0;
+#endif
+}
+
+BIGINT_API
+int bigint_reserve(bigint* b, size_t bits) {
+    size_t size = bits / BIGINT_WORD_BIT + (bits % BIGINT_WORD_BIT != 0);
+#ifdef BIGINT_NO_MALLOC
+    if(size * BIGINT_WORD_SIZE > BIGINT_DEFAULT_LIMIT) return BIGINT_ENOMEM;
+    if(size * BIGINT_WORD_SIZE > b->limit) return BIGINT_ELIMIT;
+    return 0;
+#else
+    size_t alloc = (size + BIGINT_BLOCK_SIZE-1) & -BIGINT_BLOCK_SIZE;
+    if(alloc * BIGINT_WORD_SIZE > b->limit) return BIGINT_ELIMIT;
+    if(b->alloc >= size) return 0;
+#ifdef BIGINT_INLINE_WORDS
+    if(size <= BIGINT_INLINE_WORDS) alloc = size;
+#endif
+    return bigint_set_alloc(b,alloc);
+#endif
+}
+
+BIGINT_API
+int bigint_shrink_to_fit(bigint* b) {
+#ifdef BIGINT_NO_MALLOC
+    (void)b;
+    return 0;
+#else
+    size_t alloc = (b->size + BIGINT_BLOCK_SIZE-1) & -BIGINT_BLOCK_SIZE;
+    /* a view doesn't own its words */
+    if(b->alloc == 0) return 0;
+#ifdef BIGINT_INLINE_WORDS
+    if(b->size <= BIGINT_INLINE_WORDS) alloc = b->size;
+#endif
+    return bigint_set_alloc(b,alloc);
 #endif
 }
 
@@ -1145,7 +2658,7 @@ int bigint_copy(bigint *dest, const bigint *src) {
     limit = dest->limit;
     dest->limit = src->limit;
     if(src->size != dest->size) {
-        r = bigint_resize(dest,src->size);
+        r = bigint_resize_uninit(dest,src->size);
         if(r) {
             dest->limit = limit;
             return r;
@@ -1164,6 +2677,24 @@ int bigint_copy(bigint *dest, const bigint *src) {
     return 0;
 }
 
+#ifndef BIGINT_NO_MALLOC
+BIGINT_API
+void bigint_view(bigint* b, const bigint_word* words, size_t size, int negative) {
+    size_t limit;
+    while(size && words[size - 1] == 0) size--;
+
+    /* allow copying the view into a default bigint */
+    limit = ((size + BIGINT_BLOCK_SIZE-1) & -BIGINT_BLOCK_SIZE) * BIGINT_WORD_SIZE;
+    if(limit < BIGINT_DEFAULT_LIMIT) limit = BIGINT_DEFAULT_LIMIT;
+
+    b->words = size ? (bigint_word*)words : NULL;
+    b->size = size;
+    b->alloc = 0;
+    b->limit = limit;
+    b->sign = size && negative;
+}
+#endif
+
 BIGINT_API
 int bigint_from_word(bigint* b, bigint_word val) {
     bigint_reset(b);
@@ -1429,170 +2960,878 @@ int bigint_add_signed(bigint* c, const bigint* a, size_t a_sign, const bigint* b
     return 0;
 }
 
-BIGINT_API
-int bigint_add(bigint* c, const bigint* a, const bigint* b) {
+/* performs a += b (or a -= b if negate is set), taking
+ * signs into account. a must not alias b */
+static
+int bigint_acc_signed(bigint* a, const bigint* b, size_t negate) {
     int r;
-    bigint tmp = BIGINT_INIT;
+    int cmp;
+    size_t b_sign = b->sign ^ negate;
+
+    if(b->size == 0) return 0;
+
+    if(a->size == 0 || a->sign == b_sign) {
+        a->sign = b_sign;
+        return bigint_add_unsigned(a, b);
+    }
+
+    cmp = bigint_cmp_abs(a,b);
+    if(cmp >= 0) return bigint_sub_unsigned(a, b);
+
+    if( (r = bigint_rsub_unsigned(a, b)) != 0) return r;
+    a->sign = b_sign;
+    return 0;
+}
+
+/* c = a + b with b taking the sign b_sign. Works in c directly, when c
+ * is one of the operands the other is added to or subtracted from it */
+static
+int bigint_add_sign(bigint* c, const bigint* a, const bigint* b, size_t b_sign) {
+    int r;
+    size_t negate = b_sign ^ b->sign;
+
+    if(c == a && c == b) {
+        if(negate) {
+            bigint_reset(c);
+            return 0;
+        }
+        return bigint_lshift_overwrite(c, 1);
+    }
+    if(c == a) return bigint_acc_signed(c, b, negate);
+    if(c == b) {
+        /* a + c, or a - c as -(c - a) */
+        if( (r = bigint_acc_signed(c, a, negate)) != 0) return r;
+        c->sign = c->size && (c->sign ^ negate);
+        return 0;
+    }
+    return bigint_add_signed(c, a, a->sign, b, b_sign);
+}
+
+/* c = a * b, a temporary is only needed when c is an operand */
+static
+int bigint_mul_tmp(bigint* c, const bigint* a, const bigint* b, bigint_scratch* s) {
+    int r;
+    bigint local = BIGINT_INIT;
+    bigint* tmp;
+
+    if(c != a && c != b) return bigint_mul_unsigned(c, a, b);
 
-    if( (r = bigint_copy(&tmp,c)) != 0) return r;
-    if( (r = bigint_add_signed(&tmp, a, a->sign, b, b->sign)) != 0) goto cleanup;
-    if( (r = bigint_copy(c,&tmp)) != 0) goto cleanup;
+    tmp = bigint_tmp_take(s, &local, c->limit);
+    if( (r = bigint_mul_unsigned(tmp, a, b)) != 0) goto cleanup;
+    if( (r = bigint_copy(c,tmp)) != 0) goto cleanup;
 
     cleanup:
-    bigint_free(&tmp);
+    bigint_tmp_give(s, tmp, &local);
     return r;
 }
 
+BIGINT_API
+int bigint_add(bigint* c, const bigint* a, const bigint* b) {
+    return bigint_add_sign(c, a, b, b->sign);
+}
+
 BIGINT_API
 int bigint_sub(bigint* c, const bigint* a, const bigint* b) {
+    return bigint_add_sign(c, a, b, !b->sign);
+}
+
+BIGINT_API
+int bigint_mul(bigint* c, const bigint* a, const bigint* b) {
+    return bigint_mul_tmp(c, a, b, NULL);
+}
+
+BIGINT_API
+int bigint_sqr(bigint* c, const bigint* a) {
+    return bigint_mul_tmp(c, a, a, NULL);
+}
+
+#ifndef BIGINT_NO_MALLOC
+BIGINT_API
+void bigint_scratch_init(bigint_scratch* s) {
+    size_t i;
+    for(i = 0; i < BIGINT_SCRATCH_SIZE; i++) bigint_init(&s->slots[i]);
+    s->used = 0;
+}
+
+BIGINT_API
+void bigint_scratch_reset(bigint_scratch* s) {
+    s->used = 0;
+}
+
+BIGINT_API
+void bigint_scratch_free(bigint_scratch* s) {
+    size_t i;
+    for(i = 0; i < BIGINT_SCRATCH_SIZE; i++) bigint_free(&s->slots[i]);
+    s->used = 0;
+}
+
+BIGINT_API
+int bigint_add_scratch(bigint* c, const bigint* a, const bigint* b, bigint_scratch* s) {
+    (void)s; /* works in place, no temporaries needed */
+    return bigint_add_sign(c, a, b, b->sign);
+}
+
+BIGINT_API
+int bigint_sub_scratch(bigint* c, const bigint* a, const bigint* b, bigint_scratch* s) {
+    (void)s; /* works in place, no temporaries needed */
+    return bigint_add_sign(c, a, b, !b->sign);
+}
+
+BIGINT_API
+int bigint_mul_scratch(bigint* c, const bigint* a, const bigint* b, bigint_scratch* s) {
+    return bigint_mul_tmp(c, a, b, s);
+}
+
+BIGINT_API
+int bigint_sqr_scratch(bigint* c, const bigint* a, bigint_scratch* s) {
+    return bigint_mul_tmp(c, a, a, s);
+}
+#endif
+
+/* a native double-width division beats the multiplications of the
+ * precomputed inverse, but wider than 64 bits it's a library call */
+#if !defined(BIGINT_SINGLE_WORD_ONLY) && defined(BIGINT_DWORD_TYPE) && BIGINT_WORD_WIDTH < 8
+#define BIGINT_DIV_WORD_DOUBLE
+#endif
+
+/* bigint_div_mod_word with the denominator pre-shifted so its top bit
+ * is set (d = denominator << shift) and v = bigint_word_inverse(d).
+ * The numerator is shifted by the same amount on the fly */
+static inline
+void bigint_div_mod_word_preinv(bigint* numerator, bigint_word* remainder, bigint_word d, bigint_word v, size_t shift) {
+    size_t i;
+    bigint_word lo;
+    bigint_word r = 0;
+
+    i = numerator->size;
+
+    if(shift == 0) {
+        while(i-- > 0) {
+            numerator->words[i] = bigint_word_div2_preinv(r, numerator->words[i], d, v, &r);
+        }
+    } else if(i > 0) {
+        r = numerator->words[i - 1] >> (BIGINT_WORD_BIT - shift);
+        while(i-- > 0) {
+            lo = numerator->words[i] << shift;
+            if(i > 0) lo |= numerator->words[i - 1] >> (BIGINT_WORD_BIT - shift);
+            numerator->words[i] = bigint_word_div2_preinv(r, lo, d, v, &r);
+        }
+    }
+
+    bigint_truncate(numerator);
+    *remainder = r >> shift;
+}
+
+BIGINT_API
+void bigint_div_mod_word(bigint* numerator, bigint_word* remainder, bigint_word denominator) {
+#ifdef BIGINT_DIV_WORD_DOUBLE
+    size_t i;
+    BIGINT_DWORD_TYPE n;
+    bigint_word r = 0;
+
+    i = numerator->size;
+
+    while(i-- > 0) {
+        n = r;
+        n <<= BIGINT_WORD_BIT;
+        n |= numerator->words[i];
+        numerator->words[i] = (bigint_word)(n / denominator);
+        r = (bigint_word)(n % denominator);
+    }
+
+    bigint_truncate(numerator);
+    *remainder = r;
+#else
+    size_t shift = BIGINT_WORD_BIT - bigint_word_bitlength(denominator);
+    bigint_word d = denominator << shift;
+
+    bigint_div_mod_word_preinv(numerator, remainder, d, bigint_word_inverse(d), shift);
+#endif
+}
+
+/* div_mod_word hard-coded to some value to allow compiler-time optimizations,
+ * the division by a constant or the inverse get folded at compile time */
+#ifdef BIGINT_DIV_WORD_DOUBLE
+#define BIGINT_DIV_MOD_WORD(name, x) \
+static inline \
+void bigint_div_mod_ ## name (bigint* numerator, bigint_word* remainder) { \
+    size_t i; \
+    BIGINT_DWORD_TYPE n; \
+    bigint_word r = 0; \
+    i = numerator->size; \
+    while(i-- > 0) { \
+        n = r; \
+        n <<= BIGINT_WORD_BIT; \
+        n |= numerator->words[i]; \
+        numerator->words[i] = (bigint_word)(n / x); \
+        r = (bigint_word)(n % x); \
+    } \
+    bigint_truncate(numerator); \
+    *remainder = r; \
+}
+#else
+#define BIGINT_DIV_MOD_WORD(name, x) \
+static inline \
+void bigint_div_mod_ ## name (bigint* numerator, bigint_word* remainder) { \
+    size_t shift = BIGINT_WORD_BIT - bigint_word_bitlength(x); \
+    bigint_word d = (bigint_word)x << shift; \
+    bigint_div_mod_word_preinv(numerator, remainder, d, bigint_word_inverse(d), shift); \
+}
+#endif
+
+BIGINT_DIV_MOD_WORD(10, 10)
+BIGINT_DIV_MOD_WORD(pow10, BIGINT_WORD_POW10)
+
+/* word-at-a-time long division of |a| by |b| (Knuth, TAOCP vol. 2,
+ * 4.3.1 algorithm D). requires |a| >= |b| > 0 and q and r can't
+ * alias a or b. Signs are left to the caller */
+static
+int bigint_div_mod_unsigned(bigint* q, bigint* r, const bigint* a, const bigint* b, bigint_scratch* s) {
+    int res;
+    size_t n, m, i, j;
+    size_t shift;
+    bigint_word qhat, rhat, lo, hi, carry, borrow, vtop, vnext;
+
+    bigint local = BIGINT_INIT;
+    bigint* v = bigint_tmp_take(s, &local, b->limit);
+
+    n = b->size;
+    m = a->size - n;
+
+    if( (res = bigint_resize_uninit(q, m + 1)) != 0) goto cleanup;
+
+    /* normalize so the top word of the divisor has its high bit set,
+     * which keeps each estimated quotient word within 2 of the real one */
+    shift = BIGINT_WORD_BIT - bigint_word_bitlength(b->words[n - 1]);
+
+    /* the shifted numerator may need a word more than a's limit */
+    if( (res = bigint_copy(r, a)) != 0) goto cleanup;
+    r->limit += BIGINT_WORD_SIZE;
+    if( (res = bigint_lshift_overwrite(r, shift)) != 0) goto cleanup;
+    if( (res = bigint_resize(r, a->size + 1)) != 0) goto cleanup;
+
+    if(n == 1) {
+        vtop = b->words[0] << shift;
+        rhat = r->words[a->size];
+        j = a->size;
+        while(j-- > 0) {
+            q->words[j] = bigint_word_div2(rhat, r->words[j], vtop, &rhat);
+        }
+        r->words[0] = rhat;
+        if( (res = bigint_resize(r, 1)) != 0) goto cleanup;
+        goto done;
+    }
+
+    if( (res = bigint_lshift(v, b, shift)) != 0) goto cleanup;
+    vtop = v->words[n - 1];
+    vnext = v->words[n - 2];
+
+    j = m + 1;
+    while(j-- > 0) {
+        /* estimate the quotient word from the top two words of the
+         * remainder and the top word of the divisor */
+        if(r->words[j + n] == vtop) {
+            qhat = BIGINT_WORD_MASK;
+            rhat = r->words[j + n - 1];
+            carry = bigint_word_add(&rhat, vtop);
+        } else {
+            qhat = bigint_word_div2(r->words[j + n], r->words[j + n - 1], vtop, &rhat);
+            carry = 0;
+        }
+
+        /* refine it with the next divisor word, after this qhat is
+         * at most one too large */
+        while(!carry) {
+            lo = vnext;
+            hi = bigint_word_mul(&lo, qhat);
+            if(hi < rhat || (hi == rhat && lo <= r->words[j + n - 2])) break;
+            qhat--;
+            carry = bigint_word_add(&rhat, vtop);
+        }
+
+        /* r[j .. j+n] -= qhat * v */
+        carry = 0;
+        borrow = 0;
+        for(i = 0; i < n; i++) {
+            lo = v->words[i];
+            hi = bigint_word_mul(&lo, qhat);
+            hi += bigint_word_add(&lo, carry);
+            carry = hi;
+            hi = bigint_word_sub(&r->words[i + j], lo);
+            hi += bigint_word_sub(&r->words[i + j], borrow);
+            borrow = hi;
+        }
+        hi = bigint_word_sub(&r->words[j + n], carry);
+        hi += bigint_word_sub(&r->words[j + n], borrow);
+
+        if(hi) {
+            /* qhat was one too large, add the divisor back */
+            qhat--;
+            carry = 0;
+            for(i = 0; i < n; i++) {
+                hi = bigint_word_add(&r->words[i + j], carry);
+                hi += bigint_word_add(&r->words[i + j], v->words[i]);
+                carry = hi;
+            }
+            r->words[j + n] += carry;
+        }
+
+        q->words[j] = qhat;
+    }
+
+    if( (res = bigint_resize(r, n)) != 0) goto cleanup;
+
+    done:
+    bigint_truncate(q);
+    bigint_truncate(r);
+    res = bigint_rshift_overwrite(r, shift);
+
+    cleanup:
+    r->limit = a->limit;
+    bigint_tmp_give(s, v, &local);
+    return res;
+}
+
+#ifndef BIGINT_NO_MALLOC
+/* Burnikel-Ziegler recursive division (C. Burnikel, J. Ziegler, "Fast
+ * Recursive Division", 1998). Dividing 2n words by n words is done as
+ * two 3-by-2 half-size steps, and each of those is one recursive
+ * division plus one multiplication, so the cost follows whichever
+ * multiplication kernel the pieces end up in */
+static int bigint_div_bz_2n_1n(bigint* q, bigint* r, const bigint* a, const bigint* b, size_t n);
+
+/* divides a (up to 3k words) by b (2k words, top bit set),
+ * requires a < b * B^k */
+static
+int bigint_div_bz_3n_2n(bigint* q, bigint* r, const bigint* a, const bigint* b, size_t k) {
+    int res;
+    size_t i;
+    bigint a1 = BIGINT_INIT;
+    bigint a12 = BIGINT_INIT;
+    bigint b1 = BIGINT_INIT;
+    bigint b2 = BIGINT_INIT;
+    bigint r1 = BIGINT_INIT;
+    bigint d = BIGINT_INIT;
+
+    a1.limit = a12.limit = b1.limit = b2.limit = r1.limit = d.limit = a->limit;
+
+    if( (res = bigint_slice(&a1, a, 2 * k, k)) != 0) goto cleanup;
+    if( (res = bigint_slice(&a12, a, k, 2 * k)) != 0) goto cleanup;
+    if( (res = bigint_slice(&b1, b, k, k)) != 0) goto cleanup;
+    if( (res = bigint_slice(&b2, b, 0, k)) != 0) goto cleanup;
+
+    /* estimate q from the top two thirds of a and the top half of b */
+    if(bigint_cmp_abs(&a1, &b1) < 0) {
+        if( (res = bigint_div_bz_2n_1n(q, &r1, &a12, &b1, k)) != 0) goto cleanup;
+    } else {
+        /* q = B^k - 1, r1 = a12 - q * b1 = a12 - b1 * B^k + b1 */
+        if( (res = bigint_resize_uninit(q, k)) != 0) goto cleanup;
+        memset(q->words, 0xFF, k * BIGINT_WORD_SIZE);
+        q->sign = 0;
+        if( (res = bigint_copy(&r1, &a12)) != 0) goto cleanup;
+        if( (res = bigint_add_unsigned(&r1, &b1)) != 0) goto cleanup;
+        if( (res = bigint_lshift(&d, &b1, k * BIGINT_WORD_BIT)) != 0) goto cleanup;
+        if( (res = bigint_sub_unsigned(&r1, &d)) != 0) goto cleanup;
+    }
+
+    /* r = r1 * B^k + a3 - q * b2, which can come out negative */
+    if( (res = bigint_mul_unsigned(&d, q, &b2)) != 0) goto cleanup;
+    if( (res = bigint_slice(r, a, 0, k)) != 0) goto cleanup;
+    if( (res = bigint_add_shifted_unsigned(r, &r1, k)) != 0) goto cleanup;
+
+    if(bigint_cmp_abs(r, &d) >= 0) {
+        if( (res = bigint_sub_unsigned(r, &d)) != 0) goto cleanup;
+    } else {
+        /* r holds -(the remainder), q is at most 2 too large */
+        if( (res = bigint_rsub_unsigned(r, &d)) != 0) goto cleanup;
+        for(;;) {
+            i = 0;
+            while(bigint_word_sub(&q->words[i], 1)) i++;
+            bigint_truncate(q);
+            if(bigint_cmp_abs(r, b) <= 0) {
+                if( (res = bigint_rsub_unsigned(r, b)) != 0) goto cleanup;
+                break;
+            }
+            if( (res = bigint_sub_unsigned(r, b)) != 0) goto cleanup;
+        }
+    }
+
+    cleanup:
+    bigint_free(&a1);
+    bigint_free(&a12);
+    bigint_free(&b1);
+    bigint_free(&b2);
+    bigint_free(&r1);
+    bigint_free(&d);
+    return res;
+}
+
+/* divides a by b (n words, top bit set), requires a < b * B^n */
+static
+int bigint_div_bz_2n_1n(bigint* q, bigint* r, const bigint* a, const bigint* b, size_t n) {
+    int res;
+    size_t k;
+    bigint q1 = BIGINT_INIT;
+    bigint r1 = BIGINT_INIT;
+    bigint t = BIGINT_INIT;
+
+    if((n & 1) || n < BIGINT_BZ_THRESHOLD) {
+        if(bigint_cmp_abs(a, b) < 0) {
+            bigint_reset(q);
+            return bigint_copy(r, a);
+        }
+        return bigint_div_mod_unsigned(q, r, a, b, NULL);
+    }
+
+    q1.limit = r1.limit = t.limit = a->limit;
+    k = n / 2;
+
+    if( (res = bigint_slice(&t, a, k, 3 * k)) != 0) goto cleanup;
+    if( (res = bigint_div_bz_3n_2n(&q1, &r1, &t, b, k)) != 0) goto cleanup;
+
+    if( (res = bigint_slice(&t, a, 0, k)) != 0) goto cleanup;
+    if( (res = bigint_add_shifted_unsigned(&t, &r1, k)) != 0) goto cleanup;
+    if( (res = bigint_div_bz_3n_2n(q, r, &t, b, k)) != 0) goto cleanup;
+
+    res = bigint_add_shifted_unsigned(q, &q1, k);
+
+    cleanup:
+    bigint_free(&q1);
+    bigint_free(&r1);
+    bigint_free(&t);
+    return res;
+}
+
+/* divides |a| by |b| by splitting a into blocks the size of b and
+ * running the 2n-by-n division along them. The divisor is padded to
+ * n = j * 2^m words with j below BIGINT_BZ_THRESHOLD, so the recursion
+ * halves evenly all the way down to algorithm D. Same requirements
+ * as bigint_div_mod_unsigned */
+static
+int bigint_div_mod_bz(bigint* q, bigint* r, const bigint* a, const bigint* b) {
+    int res;
+    size_t n, m, i, blocks, shift, limit;
+    bigint an = BIGINT_INIT;
+    bigint bn = BIGINT_INIT;
+    bigint qi = BIGINT_INIT;
+    bigint z = BIGINT_INIT;
+
+    m = 1;
+    while(b->size / m >= BIGINT_BZ_THRESHOLD) m <<= 1;
+    n = ((b->size + m - 1) / m) * m;
+
+    /* normalize so bn has exactly n words with its top bit set */
+    shift = (n - b->size) * BIGINT_WORD_BIT + (BIGINT_WORD_BIT - bigint_word_bitlength(b->words[b->size - 1]));
+
+    /* the shifted numerator and the intermediate products can
+     * outgrow a's limit by a couple of divisor lengths */
+    limit = (a->size + 2 * n + 2 * BIGINT_BLOCK_SIZE) * BIGINT_WORD_SIZE;
+    an.limit = bn.limit = qi.limit = z.limit = r->limit = limit;
+
+    if( (res = bigint_copy(&bn, b)) != 0) goto cleanup;
+    bn.limit = limit;
+    bn.sign = 0;
+    if( (res = bigint_lshift_overwrite(&bn, shift)) != 0) goto cleanup;
+    if( (res = bigint_copy(&an, a)) != 0) goto cleanup;
+    an.limit = limit;
+    an.sign = 0;
+    if( (res = bigint_lshift_overwrite(&an, shift)) != 0) goto cleanup;
+
+    /* enough blocks that the top one is below bn */
+    blocks = (bigint_bitlength(&an) + n * BIGINT_WORD_BIT) / (n * BIGINT_WORD_BIT);
+    if(blocks < 2) blocks = 2;
+
+    bigint_reset(q);
+    if( (res = bigint_slice(&z, &an, (blocks - 2) * n, 2 * n)) != 0) goto cleanup;
+
+    i = blocks - 1;
+    while(i-- > 0) {
+        if( (res = bigint_div_bz_2n_1n(&qi, r, &z, &bn, n)) != 0) goto cleanup;
+        if( (res = bigint_add_shifted_unsigned(q, &qi, i * n)) != 0) goto cleanup;
+        if(i > 0) {
+            if( (res = bigint_slice(&z, &an, (i - 1) * n, n)) != 0) goto cleanup;
+            if( (res = bigint_add_shifted_unsigned(&z, r, n)) != 0) goto cleanup;
+        }
+    }
+
+    res = bigint_rshift_overwrite(r, shift);
+
+    cleanup:
+    r->limit = a->limit;
+    bigint_free(&an);
+    bigint_free(&bn);
+    bigint_free(&qi);
+    bigint_free(&z);
+    return res;
+}
+#endif
+
+static
+int bigint_div_mod_tmp(bigint* quotient, bigint* remainder, const bigint* numerator, const bigint* denominator, bigint_scratch* s) {
     int r;
-    bigint tmp = BIGINT_INIT;
 
-    if( (r = bigint_copy(&tmp,c)) != 0) return r;
-    if( (r = bigint_add_signed(&tmp, a, a->sign, b, !b->sign)) != 0) goto cleanup;
-    if( (r = bigint_copy(c,&tmp)) != 0) goto cleanup;
+    bigint quo_local = BIGINT_INIT;
+    bigint rem_local = BIGINT_INIT;
+    bigint* quo;
+    bigint* rem;
+
+    if(denominator->size == 0) return BIGINT_EINVAL;
+
+    quo = bigint_tmp_take(s, &quo_local, numerator->limit);
+    rem = bigint_tmp_take(s, &rem_local, numerator->limit);
+
+    if(bigint_cmp_abs(numerator,denominator) < 0) {
+        if( (r = bigint_copy(rem, numerator)) != 0) goto cleanup;
+#ifndef BIGINT_NO_MALLOC
+    } else if(denominator->size >= BIGINT_BZ_THRESHOLD &&
+      numerator->size - denominator->size >= BIGINT_BZ_THRESHOLD) {
+        if( (r = bigint_div_mod_bz(quo, rem, numerator, denominator)) != 0) goto cleanup;
+#endif
+    } else {
+        if( (r = bigint_div_mod_unsigned(quo, rem, numerator, denominator, s)) != 0) goto cleanup;
+    }
+
+    quo->sign = numerator->sign ^ denominator->sign;
+    rem->sign = numerator->sign;
+    bigint_truncate(quo);
+    bigint_truncate(rem);
+
+    if( (r = bigint_copy(quotient, quo)) != 0) goto cleanup;
+    if( (r = bigint_copy(remainder, rem)) != 0) goto cleanup;
+
+    cleanup:
+    bigint_tmp_give(s, rem, &rem_local);
+    bigint_tmp_give(s, quo, &quo_local);
+    return r;
+}
+
+BIGINT_API
+int bigint_div_mod(bigint* quotient, bigint* remainder, const bigint* numerator, const bigint* denominator) {
+    return bigint_div_mod_tmp(quotient, remainder, numerator, denominator, NULL);
+}
+
+#ifndef BIGINT_NO_MALLOC
+BIGINT_API
+int bigint_div_mod_scratch(bigint* quotient, bigint* remainder, const bigint* numerator, const bigint* denominator, bigint_scratch* s) {
+    return bigint_div_mod_tmp(quotient, remainder, numerator, denominator, s);
+}
+#endif
+
+static const bigint_word BIGINT_ONE_VALUE = 1;
+#ifdef BIGINT_NO_MALLOC
+static const bigint BIGINT_ONE_STORAGE = { .words[0] = BIGINT_ONE_VALUE, .size = 1, .alloc = 0, .sign = 0, .limit = BIGINT_DEFAULT_LIMIT };
+#else
+static const bigint BIGINT_ONE_STORAGE = { .words = (bigint_word*)&BIGINT_ONE_VALUE, .size = 1, .alloc = 0, .sign = 0, .limit = BIGINT_DEFAULT_LIMIT };
+#endif
+static const bigint* BIGINT_ONE = &BIGINT_ONE_STORAGE;
+
+/* sets v = floor(B^(2n) / d) where d has n words and its top bit set.
+ * Newton's iteration x' = x + x * (B^(2n) - d * x) / B^(2n), starting
+ * from the reciprocal of the top half of d, doubles the number of
+ * correct words each step. A final exact correction fixes the last
+ * few units of error */
+static
+int bigint_preinv_recip(bigint* v, const bigint* d) {
+    int res;
+    int neg;
+    size_t n, h;
+    bigint pow = BIGINT_INIT;
+    bigint dh = BIGINT_INIT;
+    bigint e = BIGINT_INIT;
+    bigint t = BIGINT_INIT;
+
+    pow.limit = dh.limit = e.limit = t.limit = d->limit;
+
+    n = d->size;
+
+    /* pow = B^(2n) */
+    if( (res = bigint_resize(&pow, 2 * n + 1)) != 0) goto cleanup;
+    pow.words[2 * n] = 1;
+
+    /* below the BZ threshold, division is as cheap as the multiplications */
+    if(n < BIGINT_BZ_THRESHOLD || n < 3) {
+        res = bigint_div_mod(v, &t, &pow, d);
+        goto cleanup;
+    }
+
+    /* one extra word of precision keeps the error after a single
+     * step down to a handful of units */
+    h = n / 2 + 1;
+    if( (res = bigint_slice(&dh, d, n - h, h)) != 0) goto cleanup;
+    if( (res = bigint_preinv_recip(v, &dh)) != 0) goto cleanup;
+    if( (res = bigint_lshift_overwrite(v, (n - h) * BIGINT_WORD_BIT)) != 0) goto cleanup;
+
+    /* e = |B^(2n) - d * v| */
+    if( (res = bigint_mul_unsigned(&e, d, v)) != 0) goto cleanup;
+    neg = bigint_cmp_abs(&e, &pow) > 0;
+    if(neg) {
+        if( (res = bigint_sub_unsigned(&e, &pow)) != 0) goto cleanup;
+    } else {
+        if( (res = bigint_rsub_unsigned(&e, &pow)) != 0) goto cleanup;
+    }
+
+    if( (res = bigint_mul_unsigned(&t, v, &e)) != 0) goto cleanup;
+    if( (res = bigint_rshift_overwrite(&t, 2 * n * BIGINT_WORD_BIT)) != 0) goto cleanup;
+    if(neg) {
+        if( (res = bigint_sub_unsigned(v, &t)) != 0) goto cleanup;
+    } else {
+        if( (res = bigint_add_unsigned(v, &t)) != 0) goto cleanup;
+    }
+
+    /* exact correction, until 0 <= B^(2n) - d * v < d */
+    if( (res = bigint_mul_unsigned(&e, d, v)) != 0) goto cleanup;
+    while(bigint_cmp_abs(&e, &pow) > 0) {
+        if( (res = bigint_sub_unsigned(v, BIGINT_ONE)) != 0) goto cleanup;
+        if( (res = bigint_sub_unsigned(&e, d)) != 0) goto cleanup;
+    }
+    if( (res = bigint_rsub_unsigned(&e, &pow)) != 0) goto cleanup;
+    while(bigint_cmp_abs(&e, d) >= 0) {
+        if( (res = bigint_add_word(v, 1)) != 0) goto cleanup;
+        if( (res = bigint_sub_unsigned(&e, d)) != 0) goto cleanup;
+    }
 
     cleanup:
-    bigint_free(&tmp);
-    return r;
+    bigint_free(&pow);
+    bigint_free(&dh);
+    bigint_free(&e);
+    bigint_free(&t);
+    return res;
 }
 
 BIGINT_API
-int bigint_mul(bigint* c, const bigint* a, const bigint* b) {
+int bigint_preinv_init(bigint_preinv* p, const bigint* denominator) {
     int r;
-    bigint tmp = BIGINT_INIT;
+    size_t n;
+
+    bigint_init(&p->d);
+    bigint_init(&p->v);
+    p->shift = 0;
+    p->sign = 0;
+
+    if(denominator->size == 0) return BIGINT_EINVAL;
 
-    if( (r = bigint_copy(&tmp,c)) != 0) return r;
-    if( (r = bigint_mul_long(&tmp, a, b)) != 0) goto cleanup;
-    if( (r = bigint_copy(c,&tmp)) != 0) goto cleanup;
+    n = denominator->size;
+    p->sign = denominator->sign;
+    p->shift = BIGINT_WORD_BIT - bigint_word_bitlength(denominator->words[n - 1]);
+
+    if( (r = bigint_copy(&p->d, denominator)) != 0) goto cleanup;
+    if( (r = bigint_lshift_overwrite(&p->d, p->shift)) != 0) goto cleanup;
+    p->d.sign = 0;
+
+    /* the Newton steps work with numbers of up to 3n words */
+    p->d.limit = (3 * n + 4 + 2 * BIGINT_BLOCK_SIZE) * BIGINT_WORD_SIZE;
+    p->v.limit = p->d.limit;
+
+    /* small denominators are left to algorithm D, which
+     * beats two schoolbook multiplications */
+    if(n < BIGINT_BZ_THRESHOLD) return 0;
+
+    if( (r = bigint_preinv_recip(&p->v, &p->d)) != 0) goto cleanup;
+    return 0;
 
     cleanup:
-    bigint_free(&tmp);
+    bigint_preinv_free(p);
     return r;
 }
 
 BIGINT_API
-void bigint_div_mod_word(bigint* numerator, bigint_word* remainder, bigint_word denominator) {
-    size_t i;
-    size_t j;
+void bigint_preinv_free(bigint_preinv* p) {
+    bigint_free(&p->d);
+    bigint_free(&p->v);
+}
 
-    bigint_word dst_word;
-    bigint_word src_word;
-    bigint_word parts[2];
-    bigint_word r = 0;
+BIGINT_API
+int bigint_div_mod_preinv(bigint* quotient, bigint* remainder, const bigint* numerator, const bigint_preinv* p) {
+    int r;
+    size_t n, i, blocks;
 
-    bigint_word div_word;
-    bigint_word mod_word;
+    bigint quo = BIGINT_INIT;
+    bigint rem = BIGINT_INIT;
+    bigint an = BIGINT_INIT;
+    bigint x = BIGINT_INIT;
+    bigint qi = BIGINT_INIT;
+    bigint t = BIGINT_INIT;
 
-    i = numerator->size;
+    if(p->d.size == 0) return BIGINT_EINVAL;
 
-    while(i-- > 0) {
-        dst_word = 0;
-        src_word = numerator->words[i];
+    n = p->d.size;
+    quo.limit = numerator->limit;
+    rem.limit = x.limit = qi.limit = t.limit = p->d.limit;
+
+    if( (r = bigint_copy(&an, numerator)) != 0) goto cleanup;
+    an.limit = numerator->limit + BIGINT_WORD_SIZE;
+    an.sign = 0;
+    if( (r = bigint_lshift_overwrite(&an, p->shift)) != 0) goto cleanup;
 
-        parts[0] = src_word >> BIGINT_HALF_WORD_BIT;
-        parts[1] = src_word & BIGINT_HALF_WORD_MASK;
+    if(p->v.size == 0) {
+        if(bigint_cmp_abs(&an, &p->d) < 0) {
+            if( (r = bigint_copy(&rem, &an)) != 0) goto cleanup;
+        } else {
+            if( (r = bigint_div_mod_unsigned(&quo, &rem, &an, &p->d, NULL)) != 0) goto cleanup;
+        }
+        blocks = 0;
+    } else {
+        /* Barrett reduction of one n-word block at a time,
+         * x = rem * B^n + block is below d * B^n <= B^(2n) */
+        blocks = (an.size + n - 1) / n;
+    }
+    i = blocks;
+    while(i-- > 0) {
+        if( (r = bigint_slice(&x, &an, i * n, n)) != 0) goto cleanup;
+        if( (r = bigint_add_shifted_unsigned(&x, &rem, n)) != 0) goto cleanup;
 
-        for(j=0;j<2;j++) {
-            r <<= BIGINT_HALF_WORD_BIT;
-            r |= parts[j];
+        if(bigint_cmp_abs(&x, &p->d) < 0) {
+            /* usually the top block, no quotient words here */
+            if( (r = bigint_copy(&rem, &x)) != 0) goto cleanup;
+            continue;
+        }
 
-            div_word = r / denominator;
-            mod_word = r % denominator;
-            r = mod_word;
+        /* qi = ((x >> (n - 1) words) * v) >> (n + 1) words, at most 2 too small */
+        if( (r = bigint_slice(&t, &x, n - 1, n + 1)) != 0) goto cleanup;
+        if( (r = bigint_mul_unsigned(&qi, &t, &p->v)) != 0) goto cleanup;
+        if( (r = bigint_rshift_overwrite(&qi, (n + 1) * BIGINT_WORD_BIT)) != 0) goto cleanup;
 
-            dst_word <<= BIGINT_HALF_WORD_BIT;
-            dst_word |= div_word;
+        if( (r = bigint_mul_unsigned(&t, &qi, &p->d)) != 0) goto cleanup;
+        if( (r = bigint_sub_unsigned(&x, &t)) != 0) goto cleanup;
+        while(bigint_cmp_abs(&x, &p->d) >= 0) {
+            if( (r = bigint_sub_unsigned(&x, &p->d)) != 0) goto cleanup;
+            if( (r = bigint_add_word(&qi, 1)) != 0) goto cleanup;
         }
 
-        numerator->words[i] = dst_word;
+        if( (r = bigint_add_shifted_unsigned(&quo, &qi, i * n)) != 0) goto cleanup;
+        if( (r = bigint_copy(&rem, &x)) != 0) goto cleanup;
     }
 
-    bigint_truncate(numerator);
-    *remainder = r;
-}
+    if( (r = bigint_rshift_overwrite(&rem, p->shift)) != 0) goto cleanup;
+    rem.limit = numerator->limit;
 
-/* div_mod_word hard-coded to some value to allow compiler-time optimizations */
-#define BIGINT_DIV_MOD_WORD(x) \
-static inline \
-void bigint_div_mod_ ## x (bigint* numerator, bigint_word* remainder) { \
-    size_t i; \
-    size_t j; \
-    bigint_word dst_word; \
-    bigint_word src_word; \
-    bigint_word parts[2]; \
-    bigint_word r = 0; \
-    bigint_word div_word; \
-    bigint_word mod_word; \
-    i = numerator->size; \
-    while(i-- > 0) { \
-        dst_word = 0; \
-        src_word = numerator->words[i]; \
-        parts[0] = src_word >> BIGINT_HALF_WORD_BIT; \
-        parts[1] = src_word & BIGINT_HALF_WORD_MASK; \
-        for(j=0;j<2;j++) { \
-            r <<= BIGINT_HALF_WORD_BIT; \
-            r |= parts[j]; \
-            div_word = r / x; \
-            mod_word = r % x; \
-            r = mod_word; \
-            dst_word <<= BIGINT_HALF_WORD_BIT; \
-            dst_word |= div_word; \
-        } \
-        numerator->words[i] = dst_word; \
-    } \
-    bigint_truncate(numerator); \
-    *remainder = r; \
+    quo.sign = numerator->sign ^ p->sign;
+    rem.sign = numerator->sign;
+    bigint_truncate(&quo);
+    bigint_truncate(&rem);
+
+    if( (r = bigint_copy(quotient, &quo)) != 0) goto cleanup;
+    if( (r = bigint_copy(remainder, &rem)) != 0) goto cleanup;
+
+    cleanup:
+    bigint_free(&quo);
+    bigint_free(&rem);
+    bigint_free(&an);
+    bigint_free(&x);
+    bigint_free(&qi);
+    bigint_free(&t);
+    return r;
 }
 
-BIGINT_DIV_MOD_WORD(10)
+BIGINT_API
+void bigint_divexact_word(bigint* numerator, bigint_word denominator) {
+    size_t i;
+    size_t shift = 0;
+    bigint_word inv, lo, hi;
+    bigint_word borrow = 0;
+
+    assert(denominator != 0);
+    if(denominator == 0) return;
+
+    while(!(denominator & 1)) {
+        denominator >>= 1;
+        shift++;
+    }
+    if(shift) bigint_rshift_overwrite(numerator, shift);
+
+    inv = bigint_word_inverse_2adic(denominator);
+
+    /* each quotient word is fixed by the low word of what's left,
+     * the high half of q * d carries into the next word */
+    for(i = 0; i < numerator->size; i++) {
+        lo = numerator->words[i];
+        hi = bigint_word_sub(&lo, borrow);
+        lo = (bigint_word)(1u * lo * inv);
+        numerator->words[i] = lo;
+        borrow = bigint_word_mul(&lo, denominator) + hi;
+    }
+
+    bigint_truncate(numerator);
+}
 
 BIGINT_API
-int bigint_div_mod(bigint* quotient, bigint* remainder, const bigint* numerator, const bigint* denominator) {
+int bigint_divexact(bigint* quotient, const bigint* numerator, const bigint* denominator) {
     int r;
-    size_t n;
+    size_t i, j, m, n, end, shift;
+    bigint_word inv, qw, lo, hi, carry, borrow;
 
-    bigint quo = BIGINT_INIT;
-    bigint rem = BIGINT_INIT;
+    bigint num = BIGINT_INIT;
     bigint den = BIGINT_INIT;
+    bigint quo = BIGINT_INIT;
 
-    if( (r = bigint_copy(&rem, numerator)) != 0) goto cleanup;
-    if( (r = bigint_copy(&den, denominator)) != 0) goto cleanup;
+    if(denominator->size == 0) return BIGINT_EINVAL;
+
+    /* make the denominator odd, the numerator has at
+     * least as many trailing zero bits */
+    shift = 0;
+    while(denominator->words[shift / BIGINT_WORD_BIT] == 0) shift += BIGINT_WORD_BIT;
+    lo = denominator->words[shift / BIGINT_WORD_BIT];
+    while(!(lo & 1)) {
+        lo >>= 1;
+        shift++;
+    }
 
-    if(bigint_cmp_abs(&rem,denominator) >= 0) {
-        n = bigint_bitlength(numerator) - bigint_bitlength(denominator);
-        if( (r = bigint_lshift(&den, denominator, n)) != 0) goto cleanup;
-        n++; /* ensure we have at least 1 iteration */
-        while(n--) {
-            if(bigint_cmp_abs(&rem,&den) >= 0) {
-                if( (r = bigint_sub_unsigned(&rem, &den)) != 0) goto cleanup;
-                if( (r = bigint_set_bit(&quo, (size_t)n, 1)) != 0) goto cleanup;
+    if( (r = bigint_copy(&num, numerator)) != 0) goto cleanup;
+    if( (r = bigint_rshift_overwrite(&num, shift)) != 0) goto cleanup;
+    if( (r = bigint_copy(&den, denominator)) != 0) goto cleanup;
+    if( (r = bigint_rshift_overwrite(&den, shift)) != 0) goto cleanup;
+    quo.limit = numerator->limit;
+
+    n = den.size;
+
+    if(n == 1) {
+        bigint_divexact_word(&num, den.words[0]);
+        if( (r = bigint_copy(&quo, &num)) != 0) goto cleanup;
+    } else if(num.size >= n) {
+        /* Jebelean's exact division, quotient words come from the
+         * low end and only the low m words of the numerator matter */
+        m = num.size - n + 1;
+        if( (r = bigint_resize_uninit(&quo, m)) != 0) goto cleanup;
+        inv = bigint_word_inverse_2adic(den.words[0]);
+
+        for(i = 0; i < m; i++) {
+            qw = (bigint_word)(1u * num.words[i] * inv);
+            quo.words[i] = qw;
+
+            /* num[i .. m) -= qw * den */
+            end = m - i < n ? m - i : n;
+            carry = 0;
+            borrow = 0;
+            for(j = 0; j < end; j++) {
+                lo = den.words[j];
+                hi = bigint_word_mul(&lo, qw);
+                hi += bigint_word_add(&lo, carry);
+                carry = hi;
+                hi = bigint_word_sub(&num.words[i + j], lo);
+                hi += bigint_word_sub(&num.words[i + j], borrow);
+                borrow = hi;
+            }
+            for(j = i + end; j < m && (carry || borrow); j++) {
+                hi = bigint_word_sub(&num.words[j], carry);
+                hi += bigint_word_sub(&num.words[j], borrow);
+                borrow = hi;
+                carry = 0;
             }
-            if( (r = bigint_rshift_overwrite(&den,1)) != 0) goto cleanup;
         }
     }
 
     quo.sign = numerator->sign ^ denominator->sign;
-    rem.sign = numerator->sign;
+    bigint_truncate(&quo);
 
-    if( (r = bigint_copy(quotient, &quo)) != 0) goto cleanup;
-    if( (r = bigint_copy(remainder, &rem)) != 0) goto cleanup;
+    r = bigint_copy(quotient, &quo);
 
     cleanup:
-    bigint_free(&quo);
-    bigint_free(&rem);
+    bigint_free(&num);
     bigint_free(&den);
+    bigint_free(&quo);
     return r;
 }
 
-static const bigint_word BIGINT_ONE_VALUE = 1;
-#ifdef BIGINT_NO_MALLOC
-static const bigint BIGINT_ONE_STORAGE = { .words[0] = BIGINT_ONE_VALUE, .size = 1, .alloc = 0, .sign = 0, .limit = BIGINT_DEFAULT_LIMIT };
-#else
-static const bigint BIGINT_ONE_STORAGE = { .words = (bigint_word*)&BIGINT_ONE_VALUE, .size = 1, .alloc = 0, .sign = 0, .limit = BIGINT_DEFAULT_LIMIT };
-#endif
-static const bigint* BIGINT_ONE = &BIGINT_ONE_STORAGE;
-
 BIGINT_API
 int bigint_inc(bigint* c, const bigint *a) {
     return bigint_add(c, a, BIGINT_ONE);
@@ -1629,48 +3868,236 @@ static size_t bigint_len_string_base2(const bigint* b) {
     return bigint_bitlength(b);
 }
 
-static const char* const bigint_alphabet = "0123456789abcdef";
+/* bases that are a power of two, with bits per digit */
+static size_t bigint_len_string_pow2(const bigint* b, unsigned int bits) {
+    size_t blen = bigint_bitlength(b);
+
+    return (blen / bits) + (!!(blen % bits));
+}
+
+/* pre-computed log(2) / log(base), rounded up */
+static const double bigint_base_scale[37] = {
+    0.0, 0.0,
+    0x1.0000000000000p+0, 0x1.430939835353ep-1, 0x1.0000000000000p-1,
+    0x1.b903469050f74p-2, 0x1.8c23246dc0aa0p-2, 0x1.6cc193acea9b6p-2,
+    0x1.5555555555556p-2, 0x1.430939835353ep-2, 0x1.34413509f79ffp-2,
+    0x1.28009c1dd6454p-2, 0x1.1da3383416064p-2, 0x1.14b94f8d96420p-2,
+    0x1.0cf3ffed2d6adp-2, 0x1.0619dc46d3e16p-2, 0x1.0000000000000p-2,
+    0x1.f50b57eac5885p-3, 0x1.eb22cc68aa6e4p-3, 0x1.e21e1180c5dacp-3,
+    0x1.d9dcd21439836p-3, 0x1.d244c78367a0ep-3, 0x1.cb40589ac173fp-3,
+    0x1.c4bd95ba8d72cp-3, 0x1.bead76898f8cfp-3, 0x1.b903469050f74p-3,
+    0x1.b3b433f2eb070p-3, 0x1.aeb6f759c46fdp-3, 0x1.aa038eb0e3bfep-3,
+    0x1.a593062b38d8dp-3, 0x1.a15f4c32b95a3p-3, 0x1.9d630dccc7de0p-3,
+    0x1.999999999999ap-3, 0x1.95fec808a6095p-3, 0x1.928ee7b0b4f23p-3,
+    0x1.8f46acf8c06e4p-3, 0x1.8c23246dc0aa0p-3
+};
+
+/* like bigint_len_string_base10, for any base from 2 to 36 */
+static size_t bigint_len_string_base(const bigint* b, unsigned int base) {
+    size_t blen = (size_t)(((double)bigint_bitlength(b)) * bigint_base_scale[base]);
+
+    return ++blen;
+}
+
+/* c = base^e, by squaring powers of base that fill a word */
+static int bigint_pow_word(bigint* c, unsigned int base, size_t e) {
+    bigint tmp = BIGINT_INIT;
+    bigint_word pow;
+    size_t digits = bigint_word_chunk(base, &pow);
+    size_t n = e / digits;
+    size_t bit = 1;
+    bigint_word p = 1;
+    int r;
+
+    tmp.limit = c->limit;
+
+    if( (r = bigint_from_word(c, 1)) != 0) goto cleanup;
+
+    while(bit <= n / 2) bit <<= 1;
+    for(; n && bit; bit >>= 1) {
+        if( (r = bigint_sqr_unsigned(&tmp, c)) != 0) goto cleanup;
+        if( (r = bigint_copy(c, &tmp)) != 0) goto cleanup;
+        if(n & bit) {
+            if( (r = bigint_mul_word(c, pow)) != 0) goto cleanup;
+        }
+    }
+
+    e %= digits;
+    while(e--) p = (bigint_word)(p * base);
+    r = bigint_mul_word(c, p);
+
+    cleanup:
+    bigint_free(&tmp);
+    return r;
+}
+
+/* log2(m) for 1 <= m < 2, a bit at a time by squaring, good to about
+ * 2^-32. Saves pulling in libm */
+static double bigint_log2_frac(double m) {
+    double r = 0.0;
+    double bit = 0.5;
+    int i;
+
+    for(i = 0; i < 32; i++) {
+        m *= m;
+        if(m >= 2.0) {
+            m *= 0.5;
+            r += bit;
+        }
+        bit *= 0.5;
+    }
+    return r;
+}
+
+/* the top 64 or more bits of |b| scaled to 1 <= m < 2, b has at
+ * least two words. The top word can hold as little as one bit, so
+ * this reads a word past 64 bits */
+static double bigint_top_double(const bigint* b) {
+    double m = 0.0;
+    size_t i = b->size;
+    size_t bits = 0;
+
+    while(i-- > 0 && bits < 64 + BIGINT_WORD_BIT) {
+        m = m * ((double)BIGINT_WORD_MASK + 1.0) + (double)b->words[i];
+        bits += BIGINT_WORD_BIT;
+    }
+    while(m >= 2.0) m *= 0.5;
+    return m;
+}
+
+/* the exact number of digits of |b| in a base from 2 to 36 */
+static int bigint_len_string_exact(const bigint* b, unsigned int base, size_t* len) {
+    bigint p = BIGINT_INIT;
+    bigint_word w;
+    size_t blen;
+    size_t u;
+    double x;
+    double err;
+    int r;
+
+    if(b->size <= 1) {
+        w = b->size ? b->words[0] : 0;
+        for(u = 1; w >= base; u++) w /= base;
+        *len = u;
+        return 0;
+    }
+
+    /* the digit count is one more than the floor of log_base |b|,
+     * taken from the top bits. err bounds the rounding in that, which
+     * grows with the bit length through the scale */
+    blen = bigint_bitlength(b);
+    x = ((double)(blen - 1) + bigint_log2_frac(bigint_top_double(b))) * bigint_base_scale[base];
+    err = (double)blen * 0x1p-48 + 0x1p-16;
+    u = (size_t)x;
+    if(x - (double)u > err && x - (double)u < 1.0 - err) {
+        *len = u + 1;
+        return 0;
+    }
+
+    /* too close to a power of base to tell, the estimate is the digit
+     * count or one over depending on whether |b| reaches base^(u-1) */
+    u = base == 10 ? bigint_len_string_base10(b) : bigint_len_string_base(b, base);
+    p.limit = b->limit + 2 * BIGINT_BLOCK_SIZE * BIGINT_WORD_SIZE;
+    if( (r = bigint_pow_word(&p, base, u - 1)) != 0) goto cleanup;
+    *len = bigint_cmp_abs(b, &p) < 0 ? u - 1 : u;
+
+    cleanup:
+    bigint_free(&p);
+    return r;
+}
+
+static const char* const bigint_alphabet = "0123456789abcdefghijklmnopqrstuvwxyz";
 
+/* writes the digits of a base 2^bits straight from the words, if there
+ * are more than len digits only the top len are written */
 BIGINT_NONNULL1
-static size_t bigint_to_string_base16(char* str, size_t len, bigint* b) {
-    size_t u = 0;
+static size_t bigint_to_string_pow2(char* str, size_t len, const bigint* b, unsigned int bits) {
+    const bigint_word mask = (bigint_word)((1U << bits) - 1);
+    size_t blen;
+    size_t bit;
+    size_t w;
+    size_t u;
+    unsigned int shift;
+    bigint_word digit;
 
     if(b->size == 0) {
         str[0] = '0';
         return 1;
     }
 
-    while( (u = bigint_len_string_base16(b)) > len) {
-        bigint_rshift_overwrite_small_4(b);
-    }
-    len = u;
-
-    while(b->size) {
-        str[--u] = bigint_alphabet[b->words[0] & 0x0F];
-        bigint_rshift_overwrite_small_4(b);
+    blen = bigint_bitlength(b);
+    bit = (blen + bits - 1) / bits * bits;
+    if(len > bit / bits) len = bit / bits;
+
+    for(u = 0; u < len; u++) {
+        bit -= bits;
+        w = bit / BIGINT_WORD_BIT;
+        shift = (unsigned int)(bit % BIGINT_WORD_BIT);
+        digit = (bigint_word)(b->words[w] >> shift);
+        if(shift + bits > BIGINT_WORD_BIT && w + 1 < b->size) {
+            digit |= (bigint_word)(b->words[w+1] << (BIGINT_WORD_BIT - shift));
+        }
+        str[u] = bigint_alphabet[digit & mask];
     }
 
     return len;
 }
 
 BIGINT_NONNULL1
-static size_t bigint_to_string_base10(char* str, size_t len, bigint* b) {
+static size_t bigint_to_string_base16(char* str, size_t len, const bigint* b) {
+    return bigint_to_string_pow2(str, len, b, 4);
+}
+
+static const char bigint_digit_pairs[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/* any base from 2 to 36 the same way as base 10, a word-sized chunk
+ * of digits per division. Used for the bases without a faster path */
+BIGINT_NONNULL1
+static size_t bigint_to_string_base(char* str, size_t len, bigint* b, unsigned int base) {
+    bigint_word pow;
     bigint_word rem;
-    size_t u = 0;
+    bigint_word p;
+    size_t digits = bigint_word_chunk(base,&pow);
+    size_t u;
+    size_t i;
 
     if(b->size == 0) {
         str[0] = '0';
         return 1;
     }
 
-    while( (u = bigint_len_string_base10(b)) > len) {
-        bigint_div_mod_10(b,&rem);
+    u = bigint_len_string_base(b,base);
+    if(u > len) {
+        if(bigint_len_string_exact(b,base,&u) != 0) return 0;
+    }
+    if(u > len) {
+        for(i = u - len; i >= digits; i -= digits) {
+            bigint_div_mod_word(b,&rem,pow);
+        }
+        if(i) {
+            p = 1;
+            while(i--) p = (bigint_word)(p * base);
+            bigint_div_mod_word(b,&rem,p);
+        }
+        u = len;
     }
     len = u;
 
     while(b->size) {
-        bigint_div_mod_10(b,&rem);
-        str[--u] = bigint_alphabet[rem];
+        bigint_div_mod_word(b,&rem,pow);
+        i = u - digits;
+        do {
+            str[--u] = bigint_alphabet[rem % base];
+            rem /= base;
+        } while(rem);
+        if(b->size) {
+            while(u > i) str[--u] = '0';
+        }
     }
 
     if(u) {
@@ -1681,67 +4108,169 @@ static size_t bigint_to_string_base10(char* str, size_t len, bigint* b) {
     return len;
 }
 
+/* writes the digits of b so the last one lands at str[u - 1] and
+ * returns where the first one went. b ends up zero */
 BIGINT_NONNULL1
-static size_t bigint_to_string_base8(char* str, size_t len, bigint* b) {
-    size_t u = 0;
+static size_t bigint_to_string_base10_chunked(char* str, size_t u, bigint* b) {
+    bigint_word rem;
+    size_t i;
 
-    if(b->size == 0) {
-        str[0] = '0';
-        return 1;
+    /* BIGINT_WORD_DIGITS10 digits per division, two at a time out of
+     * the remainder, every chunk but the top one is zero-padded */
+    while(b->size) {
+        bigint_div_mod_pow10(b,&rem);
+        i = u - BIGINT_WORD_DIGITS10;
+        while(rem >= 100) {
+            u -= 2;
+            memcpy(&str[u],&bigint_digit_pairs[(rem % 100) * 2],2);
+            rem /= 100;
+        }
+        if(rem >= 10) {
+            u -= 2;
+            memcpy(&str[u],&bigint_digit_pairs[rem * 2],2);
+        } else if(rem) {
+            str[--u] = (char)('0' + rem);
+        }
+        if(b->size) {
+            while(u > i) str[--u] = '0';
+        }
+    }
+
+    return u;
+}
+
+#ifndef BIGINT_NO_MALLOC
+/* b is below 10^(BIGINT_STRING_DC_DIGITS << k), it's split by
+ * pow[k-1] = 10^(BIGINT_STRING_DC_DIGITS << (k-1)) and the halves are
+ * written recursively, the low one zero-padded. The digits end at
+ * str[*u - 1] and *u is moved to the first one written, with pad set
+ * that's always *u - (BIGINT_STRING_DC_DIGITS << k). b is destroyed */
+BIGINT_NONNULL1
+static int bigint_to_string_base10_dc(char* str, size_t* u, bigint* b, const bigint* pow, size_t k, int pad) {
+    bigint q = BIGINT_INIT;
+    size_t end = *u;
+    int r;
+
+    if(k == 0) {
+        *u = bigint_to_string_base10_chunked(str,end,b);
+        if(pad) {
+            while(*u > end - BIGINT_STRING_DC_DIGITS) str[--*u] = '0';
+        }
+        return 0;
     }
+    k--;
 
-    while( (u = bigint_len_string_base8(b)) > len) {
-        bigint_rshift_overwrite_small_3(b);
+    /* no high half to write */
+    if(!pad && bigint_cmp_abs(b,&pow[k]) < 0) {
+        return bigint_to_string_base10_dc(str,u,b,pow,k,0);
     }
-    len = u;
 
-    while(b->size) {
-        str[--u] = bigint_alphabet[b->words[0] & 0x07];
-        bigint_rshift_overwrite_small_3(b);
+    q.limit = b->limit;
+    if( (r = bigint_div_mod(&q,b,b,&pow[k])) != 0) goto cleanup;
+    if( (r = bigint_to_string_base10_dc(str,u,b,pow,k,1)) != 0) goto cleanup;
+    r = bigint_to_string_base10_dc(str,u,&q,pow,k,pad);
+
+    cleanup:
+    bigint_free(&q);
+    return r;
+}
+
+/* the divide and conquer version of bigint_to_string_base10_chunked,
+ * same in and out for u. The powers of ten come from c, or a cache of
+ * its own if c is NULL */
+BIGINT_NONNULL1
+static int bigint_to_string_base10_big(char* str, size_t* u, bigint* b, bigint_pow10_cache* c) {
+    bigint_pow10_cache local;
+    size_t k = 0;
+    int r;
+
+    /* u is at least the digit count */
+    while(((size_t)BIGINT_STRING_DC_DIGITS << k) < *u) k++;
+
+    if(c == NULL) {
+        bigint_pow10_cache_init(&local);
+        c = &local;
     }
+    if( (r = bigint_pow10_cache_build(c,k - 1,b->limit + 4 * BIGINT_BLOCK_SIZE * BIGINT_WORD_SIZE)) != 0) goto cleanup;
+    r = bigint_to_string_base10_dc(str,u,b,c->pow,k,0);
 
-    return len;
+    cleanup:
+    if(c == &local) bigint_pow10_cache_free(&local);
+    return r;
 }
+#endif
 
 BIGINT_NONNULL1
-static size_t bigint_to_string_base2(char* str, size_t len, bigint* b) {
+static size_t bigint_to_string_base10(char* str, size_t len, bigint* b, bigint_pow10_cache* c) {
+    bigint_word rem;
+    bigint_word p;
     size_t u = 0;
+    size_t i;
 
     if(b->size == 0) {
         str[0] = '0';
         return 1;
     }
 
-    while( (u = bigint_bitlength(b)) > len) {
-        bigint_rshift_overwrite_small_1(b);
+    /* only the top len digits fit, the estimate can be one over so
+     * this needs the exact count */
+    u = bigint_len_string_base10(b);
+    if(u > len) {
+        if(bigint_len_string_exact(b,10,&u) != 0) return 0;
+    }
+    if(u > len) {
+        for(i = u - len; i >= BIGINT_WORD_DIGITS10; i -= BIGINT_WORD_DIGITS10) {
+            bigint_div_mod_pow10(b,&rem);
+        }
+        if(i) {
+            p = 1;
+            while(i--) p *= 10;
+            bigint_div_mod_word(b,&rem,p);
+        }
+        u = len;
     }
     len = u;
 
-    while(b->size) {
-        str[--u] = bigint_alphabet[b->words[0] & 0x01];
-        bigint_rshift_overwrite_small_1(b);
+#ifndef BIGINT_NO_MALLOC
+    if(b->size >= 2 * BIGINT_STRING_DC_THRESHOLD) {
+        if(bigint_to_string_base10_big(str,&u,b,c) != 0) return 0;
+    } else
+#else
+    (void)c;
+#endif
+    u = bigint_to_string_base10_chunked(str,u,b);
+
+    if(u) {
+        memmove(&str[0],&str[u],len-u);
+        len -= u;
     }
 
     return len;
 }
 
-BIGINT_API
-size_t bigint_to_string(char* str, size_t len, const bigint* b, unsigned int base) {
+BIGINT_NONNULL1
+static size_t bigint_to_string_base8(char* str, size_t len, const bigint* b) {
+    return bigint_to_string_pow2(str, len, b, 3);
+}
+
+BIGINT_NONNULL1
+static size_t bigint_to_string_base2(char* str, size_t len, const bigint* b) {
+    return bigint_to_string_pow2(str, len, b, 1);
+}
+
+/* c is only used by base 10, and may be NULL */
+static
+size_t bigint_to_string_tmp(char* str, size_t len, const bigint* b, unsigned int base, bigint_pow10_cache* c) {
     bigint tmp = BIGINT_INIT;
     int r;
     size_t u = 0;
     size_t res = 0;
 
     if(str == NULL) {
-        switch(base) {
-            case 2: return 2 + b->sign + bigint_len_string_base2(b);
-            case 8: return 1 + b->sign + bigint_len_string_base8(b);
-            case 0: /* fall-through */
-            case 10: return b->sign + bigint_len_string_base10(b);
-            case 16: return 2 + b->sign + bigint_len_string_base16(b);
-            default: break;
-        }
-        return 0;
+        /* power-of-two bases are cheap to get exactly */
+        if(base == 0 || base == 10) return b->sign + bigint_len_string_base10(b);
+        if(base < 2 || base > 36 || (base & (base - 1)) == 0) return bigint_strlen_exact(b,base);
+        return b->sign + (b->size ? bigint_len_string_base(b,base) : 1);
     }
 
     if(len == 0) return 0;
@@ -1782,22 +4311,152 @@ size_t bigint_to_string(char* str, size_t len, const bigint* b, unsigned int bas
     }
     if(len == 0) return u;
 
-    /* TODO can this copy be avoided? */
-    if( (r = bigint_copy(&tmp,b)) != 0) return 0;
     switch(base) {
-        case 2: res = bigint_to_string_base2(str,len,&tmp); break;
-        case 8: res = bigint_to_string_base8(str,len,&tmp); break;
+        case 2: res = bigint_to_string_base2(str,len,b); break;
+        case 8: res = bigint_to_string_base8(str,len,b); break;
         case 0: /* fall-through */
-        case 10: res = bigint_to_string_base10(str,len,&tmp); break;
-        case 16: res = bigint_to_string_base16(str,len,&tmp); break;
-        default: break;
+        case 10: {
+            /* base 10 divides its way through a copy */
+            if( (r = bigint_copy(&tmp,b)) != 0) return 0;
+            res = bigint_to_string_base10(str,len,&tmp,c);
+            bigint_free(&tmp);
+            break;
+        }
+        case 16: res = bigint_to_string_base16(str,len,b); break;
+        case 4: res = bigint_to_string_pow2(str,len,b,2); break;
+        case 32: res = bigint_to_string_pow2(str,len,b,5); break;
+        default: {
+            if(base < 2 || base > 36) break;
+            if( (r = bigint_copy(&tmp,b)) != 0) return 0;
+            res = bigint_to_string_base(str,len,&tmp,base);
+            bigint_free(&tmp);
+            break;
+        }
     }
-    bigint_free(&tmp);
 
     if(res != 0) res += u;
     return res;
 }
 
+BIGINT_API
+size_t bigint_to_string(char* str, size_t len, const bigint* b, unsigned int base) {
+    return bigint_to_string_tmp(str,len,b,base,NULL);
+}
+
+#ifndef BIGINT_NO_MALLOC
+BIGINT_API
+size_t bigint_to_string_cached(char* str, size_t len, const bigint* b, unsigned int base, bigint_pow10_cache* c) {
+    return bigint_to_string_tmp(str,len,b,base,c);
+}
+#endif
+
+BIGINT_API
+size_t bigint_strlen_exact(const bigint* b, unsigned int base) {
+    size_t u = 1;
+
+    switch(base) {
+        case 2: {
+            if(b->size) u = bigint_len_string_base2(b);
+            return 2 + b->sign + u;
+        }
+        case 8: {
+            if(b->size) u = bigint_len_string_base8(b);
+            return 1 + b->sign + u;
+        }
+        case 0: /* fall-through */
+        case 10: {
+            if(bigint_len_string_exact(b,10,&u) != 0) return 0;
+            return b->sign + u;
+        }
+        case 16: {
+            if(b->size) u = bigint_len_string_base16(b);
+            return 2 + b->sign + u;
+        }
+        case 4: /* fall-through */
+        case 32: {
+            if(b->size) u = bigint_len_string_pow2(b,(unsigned int)bigint_word_bitlength((bigint_word)base) - 1);
+            return b->sign + u;
+        }
+        default: {
+            if(base < 2 || base > 36) break;
+            if(bigint_len_string_exact(b,base,&u) != 0) return 0;
+            return b->sign + u;
+        }
+    }
+    return 0;
+}
+
+BIGINT_API
+int bigint_export_bytes(void* data, size_t* count, int order, size_t size, int endian, int twos_complement, const bigint* b) {
+    unsigned char* p = (unsigned char*)data;
+    size_t bits = bigint_bitlength(b);
+    size_t needed;
+    size_t total;
+    size_t full = 0;
+    size_t i;
+    size_t k;
+    bigint_word w;
+    unsigned int byte;
+    unsigned int carry = 1;
+    int negative = twos_complement && b->sign && b->size;
+    int run;
+    int r;
+
+    if( (r = bigint_bytes_layout(0, order, size, &endian, &run)) != 0) return r;
+
+    if(twos_complement && b->size) {
+        /* room for the sign bit, except -2^n where the sign bit is
+         * also the top bit of the value */
+        bits++;
+        if(negative) {
+            for(i = 0; i < b->size - 1 && b->words[i] == 0; i++);
+            if(i == b->size - 1 && (b->words[i] & (b->words[i] - 1)) == 0) bits--;
+        }
+    }
+    needed = (bits + CHAR_BIT * size - 1) / (CHAR_BIT * size);
+
+    if(p == NULL) {
+        *count = needed;
+        return 0;
+    }
+    if(*count < needed) {
+        *count = needed;
+        return BIGINT_ELIMIT;
+    }
+    *count = needed;
+
+    if( (r = bigint_bytes_layout(needed, order, size, &endian, &run)) != 0) return r;
+    total = needed * size;
+
+    if(run && !negative) {
+        full = b->size < total / BIGINT_WORD_SIZE ? b->size : total / BIGINT_WORD_SIZE;
+        for(i = 0; i < full; i++) {
+            w = b->words[i];
+            if(run != bigint_host_endian()) w = bigint_word_bswap(w);
+            if(run == -1) {
+                memcpy(&p[i * BIGINT_WORD_SIZE], &w, BIGINT_WORD_SIZE);
+            } else {
+                memcpy(&p[total - (i + 1) * BIGINT_WORD_SIZE], &w, BIGINT_WORD_SIZE);
+            }
+        }
+    }
+
+    for(k = full * BIGINT_WORD_SIZE; k < total; k++) {
+        byte = 0;
+        if(k / BIGINT_WORD_SIZE < b->size) {
+            byte = (unsigned int)(b->words[k / BIGINT_WORD_SIZE] >> (CHAR_BIT * (k % BIGINT_WORD_SIZE))) & 0xFF;
+        }
+        if(negative) {
+            byte = (~byte & 0xFF) + carry;
+            carry = byte >> 8;
+            byte &= 0xFF;
+        }
+        p[bigint_byte_offset(k, needed, order, size, endian)] = (unsigned char)byte;
+    }
+
+    return 0;
+}
+
 BIGINT_API
 int bigint_cmp(const bigint *a, const bigint *b) {
     if(!a->size && !b->size) return 0;
@@ -215,6 +215,29 @@ void dump_bigint(const bigint* b) {
     fflush(stdout);
 }
 
+/* fills a bigint with words from a simple LCG, so tests can use
+ * large operands without spelling them out */
+int fill_bigint(bigint* b, size_t words, uint32_t seed) {
+    int r;
+    size_t i;
+    size_t j;
+    bigint_word w;
+
+    if( (r = bigint_resize(b,words)) != 0) return r;
+    for(i=0;i<words;i++) {
+        w = 0;
+        for(j=0;j<sizeof(bigint_word);j++) {
+            seed = seed * 1103515245 + 12345;
+            w = (w << 4) << 4;
+            w |= (seed >> 16) & 0xFF;
+        }
+        b->words[i] = w;
+    }
+    b->sign = 0;
+    bigint_truncate(b);
+    return 0;
+}
+
 
 UTEST(bigint,size) {
 #if BIGINT_WORD_WIDTH == 1
@@ -252,6 +275,56 @@ UTEST(bigint,limit) {
     bigint_free(&a);
 }
 
+#ifndef BIGINT_NO_MALLOC
+UTEST(bigint,view) {
+    bigint_word words[4] = { 5, 0, 1, 0 };
+    bigint_word before[4];
+    bigint a = BIGINT_INIT;
+    bigint b = BIGINT_INIT;
+    bigint v;
+
+    memcpy(before,words,sizeof(words));
+    bigint_view(&v,words,4,1);
+    ASSERT_TRUE(v.words == words);
+    ASSERT_WEQ(v.size,3);
+    ASSERT_WEQ(v.alloc,0);
+    ASSERT_WEQ(v.sign,1);
+
+    ASSERT_EQ(bigint_from_word(&b,1),0);
+    ASSERT_EQ(bigint_lshift(&a,&b,2 * BIGINT_WORD_BIT),0);
+    a.words[0] = 5;
+    a.sign = 1;
+    ASSERT_EQ(bigint_cmp(&v,&a),0);
+
+    ASSERT_EQ(bigint_mul(&b,&v,&v),0);
+    ASSERT_EQ(bigint_sqr(&a,&a),0);
+    ASSERT_EQ(bigint_cmp(&b,&a),0);
+    ASSERT_EQ(bigint_add(&b,&v,&v),0);
+    ASSERT_EQ(bigint_copy(&a,&v),0);
+    ASSERT_EQ(bigint_lshift_overwrite(&a,1),0);
+    ASSERT_EQ(bigint_cmp(&b,&a),0);
+    ASSERT_EQ(bigint_get_bit(&v,3 * BIGINT_WORD_BIT),0);
+    ASSERT_EQ(memcmp(before,words,sizeof(words)),0);
+
+    bigint_view(&v,words,1,0);
+    ASSERT_TRUE(bigint_to_string(NULL,0,&v,10) == 1);
+
+    bigint_free(&v);
+    ASSERT_TRUE(v.words == NULL);
+    ASSERT_EQ(bigint_from_u8(&v,7),0);
+    ASSERT_WEQ(v.words[0],7);
+    ASSERT_EQ(memcmp(before,words,sizeof(words)),0);
+    bigint_free(&v);
+
+    bigint_view(&v,words,0,1);
+    ASSERT_WEQ(v.size,0);
+    ASSERT_WEQ(v.sign,0);
+
+    bigint_free(&a);
+    bigint_free(&b);
+}
+#endif
+
 UTEST(bigint,from_string_base2) {
     bigint a = BIGINT_INIT;
 
@@ -275,13 +348,120 @@ UTEST(bigint,from_string_base8) {
 UTEST(bigint,from_string_base10) {
     bigint a = BIGINT_INIT;
 
-    ASSERT_EQ(bigint_from_string_base10(&a,"garbage",7),BIGINT_EINVAL);
-    ASSERT_EQ(bigint_from_string_base10(&a,BIG_STRING_DEC,strlen(BIG_STRING_DEC)),0);
+    ASSERT_EQ(bigint_from_string_base10(&a,"garbage",7,NULL),BIGINT_EINVAL);
+    ASSERT_EQ(bigint_from_string_base10(&a,BIG_STRING_DEC,strlen(BIG_STRING_DEC),NULL),0);
     ASSERT_BIGSTRING(a);
 
     bigint_free(&a);
 }
 
+UTEST(bigint,from_string_base10_chunks) {
+    bigint a = BIGINT_INIT;
+    bigint b = BIGINT_INIT;
+    char str[48];
+    size_t i;
+
+    /* 10^i for every length around the chunk boundaries */
+    ASSERT_EQ(bigint_from_word(&b,1),0);
+    for(i = 0; i < 41; i++) {
+        str[0] = '1';
+        memset(&str[1],'0',i);
+        ASSERT_EQ(bigint_from_string(&a,str,i + 1,10),0);
+        ASSERT_EQ(bigint_cmp(&a,&b),0);
+        ASSERT_EQ(bigint_mul_const_10(&b),0);
+    }
+
+    ASSERT_EQ(bigint_from_string(&a,"123456789012345678901234x5",26,10),BIGINT_EINVAL);
+
+    /* stops at a NUL inside len */
+    ASSERT_EQ(bigint_from_string(&a,"12\0" "34",5,10),0);
+    ASSERT_EQ(bigint_from_word(&b,12),0);
+    ASSERT_EQ(bigint_cmp(&a,&b),0);
+
+    bigint_free(&a);
+    bigint_free(&b);
+}
+
+UTEST(bigint,from_string_base10_dc) {
+    bigint a = BIGINT_INIT;
+    bigint b = BIGINT_INIT;
+    static char str[5 * BIGINT_STRING_DC_DIGITS + 8];
+    size_t len = sizeof(str) - 1;
+    size_t i;
+
+    a.limit = b.limit = 8192;
+
+    /* long enough to be split, compared against the chunked parser */
+    for(i = 0; i < len; i++) str[i] = (char)('0' + (i * 7 + i / 3) % 10);
+    str[0] = '9';
+    ASSERT_EQ(bigint_from_string(&a,str,len,10),0);
+    ASSERT_EQ(bigint_from_string_base10_chunked(&b,str,len),0);
+    ASSERT_EQ(bigint_cmp(&a,&b),0);
+
+    /* leading zeros */
+    memset(str,'0',2 * BIGINT_STRING_DC_DIGITS);
+    ASSERT_EQ(bigint_from_string(&a,str,len,10),0);
+    bigint_reset(&b);
+    ASSERT_EQ(bigint_from_string_base10_chunked(&b,str,len),0);
+    ASSERT_EQ(bigint_cmp(&a,&b),0);
+
+    str[len - BIGINT_STRING_DC_DIGITS] = 'x';
+    ASSERT_EQ(bigint_from_string(&a,str,len,10),BIGINT_EINVAL);
+
+    bigint_free(&a);
+    bigint_free(&b);
+}
+
+#ifndef BIGINT_NO_MALLOC
+UTEST(bigint,from_string_base10_cached) {
+    bigint a = BIGINT_INIT;
+    bigint b = BIGINT_INIT;
+    bigint_pow10_cache c;
+    static char str[9 * BIGINT_STRING_DC_DIGITS + 8];
+    const bigint_word* top;
+    size_t len = sizeof(str) - 1;
+    size_t count;
+    size_t i;
+
+    a.limit = b.limit = 16384;
+    bigint_pow10_cache_init(&c);
+
+    for(i = 0; i < len; i++) str[i] = (char)('0' + (i * 7 + i / 3) % 10);
+    str[0] = '9';
+    ASSERT_EQ(bigint_from_string_cached(&a,str,len / 2,10,&c),0);
+    ASSERT_EQ(bigint_from_string(&b,str,len / 2,10),0);
+    ASSERT_EQ(bigint_cmp(&a,&b),0);
+    ASSERT_TRUE(c.count > 0);
+
+    /* a string of the same length reuses the powers as they are */
+    count = c.count;
+    top = c.pow[count - 1].words;
+    str[1] = '0';
+    ASSERT_EQ(bigint_from_string_cached(&a,str,len / 2,10,&c),0);
+    ASSERT_EQ(bigint_from_string(&b,str,len / 2,10),0);
+    ASSERT_EQ(bigint_cmp(&a,&b),0);
+    ASSERT_EQ(c.count,count);
+    ASSERT_TRUE(c.pow[count - 1].words == top);
+
+    /* a longer one adds to them */
+    ASSERT_EQ(bigint_from_string_cached(&a,str,len,10,&c),0);
+    ASSERT_EQ(bigint_from_string(&b,str,len,10),0);
+    ASSERT_EQ(bigint_cmp(&a,&b),0);
+    ASSERT_TRUE(c.count > count);
+
+    str[0] = '-';
+    str[1] = '9';
+    ASSERT_EQ(bigint_from_string_cached(&a,str,len,0,&c),0);
+    ASSERT_EQ(bigint_from_string(&b,str,len,0),0);
+    ASSERT_EQ(bigint_cmp(&a,&b),0);
+
+    bigint_pow10_cache_free(&c);
+    ASSERT_EQ(c.count,(size_t)0);
+    bigint_free(&a);
+    bigint_free(&b);
+}
+#endif
+
 UTEST(bigint,from_string_base16) {
     bigint a = BIGINT_INIT;
 
@@ -292,6 +472,108 @@ UTEST(bigint,from_string_base16) {
     bigint_free(&a);
 }
 
+UTEST(bigint,from_string_pow2) {
+    bigint a = BIGINT_INIT;
+    bigint b = BIGINT_INIT;
+    bigint one = BIGINT_INIT;
+    char str[80];
+    size_t i;
+
+    ASSERT_EQ(bigint_from_word(&one,1),0);
+
+    /* all-ones digits cover every way a digit can straddle words */
+    for(i = 1; i < sizeof(str); i++) {
+        memset(str,'7',i);
+        ASSERT_EQ(bigint_from_string(&a,str,i,8),0);
+        ASSERT_EQ(bigint_lshift(&b,&one,3 * i),0);
+        ASSERT_EQ(bigint_dec(&b,&b),0);
+        ASSERT_EQ(bigint_cmp(&a,&b),0);
+
+        memset(str,'F',i);
+        ASSERT_EQ(bigint_from_string(&a,str,i,16),0);
+        ASSERT_EQ(bigint_lshift(&b,&one,4 * i),0);
+        ASSERT_EQ(bigint_dec(&b,&b),0);
+        ASSERT_EQ(bigint_cmp(&a,&b),0);
+
+        memset(str,'1',i);
+        ASSERT_EQ(bigint_from_string(&a,str,i,2),0);
+        ASSERT_EQ(bigint_lshift(&b,&one,i),0);
+        ASSERT_EQ(bigint_dec(&b,&b),0);
+        ASSERT_EQ(bigint_cmp(&a,&b),0);
+    }
+
+    /* leading zeros */
+    memset(str,'0',sizeof(str));
+    str[sizeof(str) - 1] = '1';
+    ASSERT_EQ(bigint_from_string(&a,str,sizeof(str),16),0);
+    ASSERT_EQ(bigint_cmp(&a,&one),0);
+
+    ASSERT_EQ(bigint_from_string(&a,"1234567x",8,8),BIGINT_EINVAL);
+    ASSERT_EQ(bigint_from_string(&a,"12345678",8,8),BIGINT_EINVAL);
+    ASSERT_EQ(bigint_from_string(&a,"abcdefg",7,16),BIGINT_EINVAL);
+
+    /* stops at a NUL inside len */
+    ASSERT_EQ(bigint_from_string(&a,"ff\0" "ff",5,16),0);
+    ASSERT_EQ(bigint_from_word(&b,0xff),0);
+    ASSERT_EQ(bigint_cmp(&a,&b),0);
+
+    bigint_free(&a);
+    bigint_free(&b);
+    bigint_free(&one);
+}
+
+UTEST(bigint,string_radix) {
+    bigint a = BIGINT_INIT;
+    bigint b = BIGINT_INIT;
+    bigint c = BIGINT_INIT;
+    char buffer[260];
+    unsigned int base;
+    size_t len;
+    size_t i;
+
+    /* every base round-trips, and agrees with building the number
+     * digit by digit */
+    ASSERT_EQ(fill_bigint(&a,128 / BIGINT_WORD_BIT,3),0);
+    for(base = 2; base <= 36; base++) {
+        len = bigint_to_string(buffer,sizeof(buffer),&a,base);
+        ASSERT_TRUE(len > 0);
+        ASSERT_EQ(bigint_strlen_exact(&a,base),len);
+        ASSERT_GE(bigint_to_string(NULL,0,&a,base),len);
+
+        ASSERT_EQ(bigint_from_string(&b,buffer,len,base),0);
+        ASSERT_EQ(bigint_cmp(&a,&b),0);
+
+        if(base == 2 || base == 8 || base == 16) continue;
+        bigint_reset(&c);
+        for(i = 0; i < len; i++) {
+            ASSERT_EQ(bigint_mul_add_word(&c,(bigint_word)base,(bigint_word)bigint_digit_value(buffer[i])),0);
+        }
+        ASSERT_EQ(bigint_cmp(&a,&c),0);
+
+        /* a short buffer gets the leading digits */
+        ASSERT_EQ(bigint_to_string(buffer + len,len - 1,&a,base),len - 1);
+        ASSERT_EQ(memcmp(buffer,buffer + len,len - 1),0);
+    }
+
+    ASSERT_EQ(bigint_from_string(&a,"ZZ",2,36),0);
+    ASSERT_EQ(bigint_from_u32(&b,36 * 36 - 1),0);
+    ASSERT_EQ(bigint_cmp(&a,&b),0);
+    ASSERT_WEQ(bigint_to_string(buffer,sizeof(buffer),&a,36),2);
+    ASSERT_EQ(memcmp(buffer,"zz",2),0);
+
+    ASSERT_EQ(bigint_from_string(&a,"123",3,3),BIGINT_EINVAL);
+    ASSERT_EQ(bigint_from_string(&a,"1v",2,32),0);
+    ASSERT_EQ(bigint_from_string(&a,"1w",2,32),BIGINT_EINVAL);
+    ASSERT_EQ(bigint_from_string(&a,"-33",3,4),0);
+    ASSERT_EQ(bigint_from_word(&b,15),0);
+    b.sign = 1;
+    ASSERT_EQ(bigint_cmp(&a,&b),0);
+
+    bigint_free(&a);
+    bigint_free(&b);
+    bigint_free(&c);
+}
+
 UTEST(bigint,from_string_einval) {
     bigint a = BIGINT_INIT;
 
@@ -300,6 +582,8 @@ UTEST(bigint,from_string_einval) {
     ASSERT_EQ(bigint_from_string(&a,"garbage",7,8),BIGINT_EINVAL);
     ASSERT_EQ(bigint_from_string(&a,"garbage",7,16),BIGINT_EINVAL);
     ASSERT_EQ(bigint_from_string(&a,"garbage",7,1),BIGINT_EINVAL);
+    ASSERT_EQ(bigint_from_string(&a,"garbage",7,37),BIGINT_EINVAL);
+    ASSERT_EQ(bigint_from_string(&a,"garbage",7,12),BIGINT_EINVAL);
 
     ASSERT_EQ(bigint_from_cstring(&a,"garbage",0),BIGINT_EINVAL);
     ASSERT_EQ(bigint_from_cstring(&a,"garbage",2),BIGINT_EINVAL);
@@ -646,6 +930,92 @@ UTEST(bigint,to_string_base16_odd) {
     bigint_free(&a);
 }
 
+UTEST(bigint,import_export_bytes) {
+    static const unsigned char be[] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0x10 };
+    static const unsigned char le[] = { 0x10, 0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01 };
+    static const unsigned char words[] = { 0x45, 0x67, 0x89, 0x10, 0xab, 0xcd, 0xef, 0x00, 0x01, 0x23 };
+    unsigned char buffer[16];
+    bigint a = BIGINT_INIT;
+    bigint b = BIGINT_INIT;
+    size_t count;
+
+    ASSERT_EQ(bigint_from_cstring(&b,"0x0123456789abcdef10",16),0);
+
+    ASSERT_EQ(bigint_import_bytes(&a,sizeof(be),1,1,0,0,be),0);
+    ASSERT_EQ(bigint_cmp(&a,&b),0);
+    ASSERT_EQ(bigint_import_bytes(&a,sizeof(le),-1,1,0,0,le),0);
+    ASSERT_EQ(bigint_cmp(&a,&b),0);
+    ASSERT_EQ(bigint_import_bytes(&a,1,1,sizeof(be),1,0,be),0);
+    ASSERT_EQ(bigint_cmp(&a,&b),0);
+
+    /* 16-bit words, least significant first, with mixed byte orders */
+    ASSERT_EQ(bigint_import_bytes(&a,5,-1,2,1,0,words),0);
+    ASSERT_EQ(bigint_from_cstring(&b,"0x0123ef00abcd89104567",16),0);
+    ASSERT_EQ(bigint_cmp(&a,&b),0);
+    count = 5;
+    ASSERT_EQ(bigint_export_bytes(buffer,&count,-1,2,1,0,&a),0);
+    ASSERT_TRUE(count == 5);
+    ASSERT_EQ(memcmp(buffer,words,sizeof(words)),0);
+
+    ASSERT_EQ(bigint_from_cstring(&a,"0x0123456789abcdef10",16),0);
+    ASSERT_EQ(bigint_export_bytes(NULL,&count,1,1,1,0,&a),0);
+    ASSERT_EQ(count,sizeof(be));
+    count = sizeof(be) - 1;
+    ASSERT_EQ(bigint_export_bytes(buffer,&count,1,1,1,0,&a),BIGINT_ELIMIT);
+    ASSERT_EQ(count,sizeof(be));
+    ASSERT_EQ(bigint_export_bytes(buffer,&count,1,1,1,0,&a),0);
+    ASSERT_EQ(memcmp(buffer,be,sizeof(be)),0);
+    ASSERT_EQ(bigint_export_bytes(buffer,&count,-1,1,1,0,&a),0);
+    ASSERT_EQ(memcmp(buffer,le,sizeof(le)),0);
+
+    /* two's complement */
+    ASSERT_EQ(bigint_from_cstring(&a,"-129",10),0);
+    count = sizeof(buffer);
+    ASSERT_EQ(bigint_export_bytes(buffer,&count,1,1,1,1,&a),0);
+    ASSERT_TRUE(count == 2);
+    ASSERT_EQ(buffer[0],0xff);
+    ASSERT_EQ(buffer[1],0x7f);
+    ASSERT_EQ(bigint_import_bytes(&b,count,1,1,1,1,buffer),0);
+    ASSERT_EQ(bigint_cmp(&a,&b),0);
+
+    ASSERT_EQ(bigint_from_cstring(&a,"-128",10),0);
+    count = sizeof(buffer);
+    ASSERT_EQ(bigint_export_bytes(buffer,&count,1,1,1,1,&a),0);
+    ASSERT_TRUE(count == 1);
+    ASSERT_EQ(buffer[0],0x80);
+
+    ASSERT_EQ(bigint_from_cstring(&a,"128",10),0);
+    count = sizeof(buffer);
+    ASSERT_EQ(bigint_export_bytes(buffer,&count,1,1,1,1,&a),0);
+    ASSERT_TRUE(count == 2);
+    ASSERT_EQ(buffer[0],0x00);
+    ASSERT_EQ(buffer[1],0x80);
+
+    /* sign-extended to a fixed width */
+    memset(buffer,0xff,4);
+    buffer[3] = 0xfe;
+    ASSERT_EQ(bigint_import_bytes(&a,1,1,4,1,1,buffer),0);
+    ASSERT_EQ(bigint_from_cstring(&b,"-2",10),0);
+    ASSERT_EQ(bigint_cmp(&a,&b),0);
+    ASSERT_EQ(bigint_import_bytes(&a,1,1,4,1,0,buffer),0);
+    ASSERT_EQ(bigint_from_cstring(&b,"4294967294",10),0);
+    ASSERT_EQ(bigint_cmp(&a,&b),0);
+
+    bigint_reset(&a);
+    ASSERT_EQ(bigint_export_bytes(NULL,&count,1,4,0,1,&a),0);
+    ASSERT_TRUE(count == 0);
+    ASSERT_EQ(bigint_import_bytes(&a,0,1,4,0,1,buffer),0);
+    ASSERT_TRUE(a.size == 0);
+
+    ASSERT_EQ(bigint_import_bytes(&a,1,0,4,0,0,buffer),BIGINT_EINVAL);
+    ASSERT_EQ(bigint_import_bytes(&a,1,1,0,0,0,buffer),BIGINT_EINVAL);
+    ASSERT_EQ(bigint_import_bytes(&a,1,1,4,2,0,buffer),BIGINT_EINVAL);
+    ASSERT_EQ(bigint_export_bytes(NULL,&count,1,4,2,0,&a),BIGINT_EINVAL);
+
+    bigint_free(&a);
+    bigint_free(&b);
+}
+
 UTEST(bigint,to_string_badbase) {
     char buffer[35];
     bigint a = BIGINT_INIT;
@@ -654,8 +1024,10 @@ UTEST(bigint,to_string_badbase) {
 
     a.words[a.size-1] |= 0x10;
 
-    ASSERT_WEQ(bigint_to_string(NULL,0,&a,9),0);
-    ASSERT_WEQ(bigint_to_string(buffer,35,&a,9),0);
+    ASSERT_WEQ(bigint_to_string(NULL,0,&a,1),0);
+    ASSERT_WEQ(bigint_to_string(buffer,35,&a,1),0);
+    ASSERT_WEQ(bigint_to_string(NULL,0,&a,37),0);
+    ASSERT_WEQ(bigint_to_string(buffer,35,&a,37),0);
 
     bigint_free(&a);
 }
@@ -714,7 +1086,7 @@ UTEST(bigint_zero,to_string_base10) {
 
     bigint a = BIGINT_INIT;
 
-    ASSERT_WEQ(bigint_to_string_base10(buffer,2,&a),1);
+    ASSERT_WEQ(bigint_to_string_base10(buffer,2,&a,NULL),1);
     buffer[1] = '\0';
     ASSERT_STREQ(buffer,"0");
 }
@@ -745,7 +1117,7 @@ UTEST(bigint,to_string_base10) {
 
     INIT_BIGSTRING(a)
 
-    ASSERT_WEQ(bigint_to_string_base10(buffer,41,&a),40);
+    ASSERT_WEQ(bigint_to_string_base10(buffer,41,&a,NULL),40);
     buffer[40] = '\0';
     ASSERT_STREQ(buffer,BIG_STRING_DEC);
     bigint_free(&a);
@@ -757,12 +1129,154 @@ UTEST(bigint,to_string_base10_trunc) {
 
     INIT_BIGSTRING(a)
 
-    ASSERT_WEQ(bigint_to_string_base10(buffer,36,&a),36);
+    ASSERT_WEQ(bigint_to_string_base10(buffer,36,&a,NULL),36);
     buffer[36] = '\0';
     ASSERT_STREQ(buffer,BIG_STRING_DEC_TRUNC);
     bigint_free(&a);
 }
 
+UTEST(bigint,to_string_base10_chunks) {
+    bigint a = BIGINT_INIT;
+    char expected[48];
+    char buffer[48];
+    size_t i;
+
+    /* 10^i and 10^i - 1 around the chunk boundaries, which need
+     * zero-padded and full chunks */
+    ASSERT_EQ(bigint_from_word(&a,1),0);
+    for(i = 0; i < 41; i++) {
+        expected[0] = '1';
+        memset(&expected[1],'0',i);
+        ASSERT_EQ(bigint_to_string(buffer,sizeof(buffer),&a,10),i + 1);
+        ASSERT_EQ(memcmp(buffer,expected,i + 1),0);
+
+        if(i > 0) {
+            ASSERT_EQ(bigint_dec(&a,&a),0);
+            memset(expected,'9',i);
+            ASSERT_EQ(bigint_to_string(buffer,sizeof(buffer),&a,10),i);
+            ASSERT_EQ(memcmp(buffer,expected,i),0);
+            ASSERT_EQ(bigint_inc(&a,&a),0);
+        }
+        ASSERT_EQ(bigint_mul_const_10(&a),0);
+    }
+
+    bigint_free(&a);
+}
+
+UTEST(bigint,to_string_base10_dc) {
+    bigint a = BIGINT_INIT;
+    bigint b = BIGINT_INIT;
+    static char expected[5 * BIGINT_STRING_DC_DIGITS];
+    static char buffer[5 * BIGINT_STRING_DC_DIGITS];
+    size_t len;
+    size_t u;
+
+    /* long enough to be split, compared against the chunked writer */
+    ASSERT_EQ(fill_bigint(&a,3 * BIGINT_STRING_DC_THRESHOLD,7),0);
+    ASSERT_EQ(bigint_copy(&b,&a),0);
+    u = bigint_to_string_base10_chunked(expected,sizeof(expected),&b);
+    len = sizeof(expected) - u;
+    ASSERT_EQ(bigint_to_string(buffer,sizeof(buffer),&a,10),len);
+    ASSERT_EQ(memcmp(buffer,&expected[u],len),0);
+
+    /* 10^n + 1 has whole runs of zeros in the padded pieces */
+    ASSERT_EQ(bigint_from_word(&a,1),0);
+    for(len = 0; len < 3 * BIGINT_STRING_DC_DIGITS; len++) {
+        ASSERT_EQ(bigint_mul_const_10(&a),0);
+    }
+    ASSERT_EQ(bigint_inc(&a,&a),0);
+    memset(expected,'0',len + 1);
+    expected[0] = '1';
+    expected[len] = '1';
+    ASSERT_EQ(bigint_to_string(buffer,sizeof(buffer),&a,10),len + 1);
+    ASSERT_EQ(memcmp(buffer,expected,len + 1),0);
+
+    bigint_free(&a);
+    bigint_free(&b);
+}
+
+#ifndef BIGINT_NO_MALLOC
+UTEST(bigint,to_string_base10_cached) {
+    bigint a = BIGINT_INIT;
+    bigint_pow10_cache c;
+    static char expected[9 * BIGINT_STRING_DC_DIGITS];
+    static char buffer[9 * BIGINT_STRING_DC_DIGITS];
+    const bigint_word* top;
+    size_t len;
+    size_t count;
+
+    bigint_pow10_cache_init(&c);
+
+    ASSERT_EQ(fill_bigint(&a,3 * BIGINT_STRING_DC_THRESHOLD,7),0);
+    len = bigint_to_string(expected,sizeof(expected),&a,10);
+    ASSERT_EQ(bigint_to_string_cached(buffer,sizeof(buffer),&a,10,&c),len);
+    ASSERT_EQ(memcmp(buffer,expected,len),0);
+    ASSERT_TRUE(c.count > 0);
+
+    /* another number of the same size reuses the powers as they are */
+    count = c.count;
+    top = c.pow[count - 1].words;
+    ASSERT_EQ(fill_bigint(&a,3 * BIGINT_STRING_DC_THRESHOLD,8),0);
+    a.sign = 1;
+    len = bigint_to_string(expected,sizeof(expected),&a,10);
+    ASSERT_EQ(bigint_to_string_cached(buffer,sizeof(buffer),&a,10,&c),len);
+    ASSERT_EQ(memcmp(buffer,expected,len),0);
+    ASSERT_EQ(c.count,count);
+    ASSERT_TRUE(c.pow[count - 1].words == top);
+
+    /* parsing it back uses the same cache */
+    ASSERT_EQ(bigint_from_string_cached(&a,buffer,len,10,&c),0);
+    ASSERT_EQ(bigint_to_string_cached(buffer,sizeof(buffer),&a,10,&c),len);
+    ASSERT_EQ(memcmp(buffer,expected,len),0);
+
+    /* a larger number adds to them */
+    ASSERT_EQ(fill_bigint(&a,7 * BIGINT_STRING_DC_THRESHOLD,9),0);
+    len = bigint_to_string(expected,sizeof(expected),&a,10);
+    ASSERT_EQ(bigint_to_string_cached(buffer,sizeof(buffer),&a,10,&c),len);
+    ASSERT_EQ(memcmp(buffer,expected,len),0);
+    ASSERT_TRUE(c.count > count);
+
+    bigint_pow10_cache_free(&c);
+    bigint_free(&a);
+}
+#endif
+
+UTEST(bigint,strlen_exact) {
+    bigint a = BIGINT_INIT;
+    char buffer[48];
+    size_t i;
+
+    ASSERT_WEQ(bigint_strlen_exact(&a,10),1);
+    ASSERT_WEQ(bigint_strlen_exact(&a,16),3);
+    ASSERT_WEQ(bigint_strlen_exact(&a,8),2);
+    ASSERT_WEQ(bigint_strlen_exact(&a,2),3);
+    ASSERT_WEQ(bigint_strlen_exact(&a,37),0);
+
+    /* 10^i - 1 and 10^i, the estimate is one over for some of these */
+    ASSERT_EQ(bigint_from_word(&a,1),0);
+    for(i = 1; i < 41; i++) {
+        ASSERT_EQ(bigint_mul_const_10(&a),0);
+        ASSERT_EQ(bigint_dec(&a,&a),0);
+        ASSERT_EQ(bigint_strlen_exact(&a,10),i);
+        ASSERT_GE(bigint_to_string(NULL,0,&a,10),i);
+
+        /* a buffer of exactly that size gets every digit */
+        ASSERT_EQ(bigint_to_string(buffer,i,&a,10),i);
+        ASSERT_EQ(buffer[i - 1],'9');
+
+        ASSERT_EQ(bigint_inc(&a,&a),0);
+        ASSERT_EQ(bigint_strlen_exact(&a,10),i + 1);
+    }
+
+    a.sign = 1;
+    ASSERT_WEQ(bigint_strlen_exact(&a,10),42);
+    ASSERT_EQ(bigint_strlen_exact(&a,10),bigint_to_string(buffer,sizeof(buffer),&a,10));
+    ASSERT_EQ(bigint_strlen_exact(&a,16),bigint_to_string(buffer,sizeof(buffer),&a,16));
+    ASSERT_EQ(bigint_strlen_exact(&a,8),bigint_to_string(buffer,sizeof(buffer),&a,8));
+
+    bigint_free(&a);
+}
+
 UTEST(bigint,to_string_base10_mem) {
     /* the to_length function for base10 will return
      * 2, even though the actual tostring only needs 1 */
@@ -772,7 +1286,7 @@ UTEST(bigint,to_string_base10_mem) {
     ASSERT_EQ(bigint_resize(&a,1),0);
     a.words[0] = 0x09;
 
-    ASSERT_WEQ(bigint_to_string_base10(buffer,2,&a),1);
+    ASSERT_WEQ(bigint_to_string_base10(buffer,2,&a,NULL),1);
     buffer[1] = '\0';
     ASSERT_STREQ(buffer,"9");
     bigint_free(&a);
@@ -1206,11 +1720,7 @@ UTEST(bigint,realloc) {
     ASSERT_EQ(a.size,(size_t)1);
     ASSERT_WEQ(a.words[0],(bigint_word)-1);
 
-#ifndef BIGINT_NO_MALLOC
-    a.size = a.alloc;
-#else
-    a.size = 8;
-#endif
+    ASSERT_EQ(bigint_resize(&a,8),0);
     memset(a.words,0xFF,a.size * sizeof(bigint_word));
 
     /* this will trigger a realloc */
@@ -1229,6 +1739,139 @@ UTEST(bigint,realloc) {
     bigint_free(&a);
 }
 
+UTEST(bigint,reserve_shrink) {
+    bigint a = BIGINT_INIT;
+#ifndef BIGINT_NO_MALLOC
+    bigint_word* words;
+#endif
+    size_t i;
+
+    ASSERT_EQ(bigint_reserve(&a,40 * BIGINT_WORD_BIT),0);
+    ASSERT_EQ(a.size,(size_t)0);
+#ifndef BIGINT_NO_MALLOC
+    ASSERT_TRUE(a.alloc >= 40);
+    words = a.words;
+#endif
+    for(i = 0; i < 40; i++) {
+        ASSERT_EQ(bigint_append(&a,(bigint_word)(i + 1)),0);
+    }
+#ifndef BIGINT_NO_MALLOC
+    /* filling the reserved words doesn't reallocate */
+    ASSERT_TRUE(a.words == words);
+#endif
+
+    ASSERT_EQ(bigint_resize(&a,2),0);
+    ASSERT_EQ(bigint_shrink_to_fit(&a),0);
+#ifndef BIGINT_NO_MALLOC
+    ASSERT_TRUE(a.alloc < 40);
+#endif
+    ASSERT_EQ(a.size,(size_t)2);
+    ASSERT_WEQ(a.words[0],1);
+    ASSERT_WEQ(a.words[1],2);
+
+    a.limit = 64;
+    ASSERT_EQ(bigint_reserve(&a,65 * CHAR_BIT),BIGINT_ELIMIT);
+    ASSERT_EQ(a.size,(size_t)2);
+
+    bigint_reset(&a);
+    ASSERT_EQ(bigint_shrink_to_fit(&a),0);
+#ifndef BIGINT_NO_MALLOC
+    ASSERT_TRUE(a.words == NULL);
+#endif
+
+    bigint_free(&a);
+}
+
+UTEST(bigint,dirty_capacity) {
+    bigint a = BIGINT_INIT;
+    bigint b = BIGINT_INIT;
+    bigint c = BIGINT_INIT;
+    size_t i;
+
+    /* leave stale words behind the size, growing again reads zeros */
+    ASSERT_EQ(bigint_resize(&a,40),0);
+    for(i = 0; i < 40; i++) a.words[i] = (bigint_word)-1;
+    ASSERT_EQ(bigint_resize(&a,2),0);
+    ASSERT_EQ(bigint_resize(&a,40),0);
+    for(i = 2; i < 40; i++) {
+        ASSERT_WEQ(a.words[i],0);
+    }
+
+    /* results written over the stale words match fresh ones */
+    for(i = 0; i < 40; i++) a.words[i] = (bigint_word)-1;
+    ASSERT_EQ(bigint_from_word(&b,3),0);
+    ASSERT_EQ(bigint_copy(&a,&b),0);
+    ASSERT_EQ(bigint_cmp(&a,&b),0);
+    ASSERT_EQ(bigint_lshift(&a,&a,5 * BIGINT_WORD_BIT + 1),0);
+    ASSERT_EQ(bigint_from_word(&c,6),0);
+    ASSERT_EQ(bigint_lshift(&c,&c,5 * BIGINT_WORD_BIT),0);
+    ASSERT_EQ(bigint_cmp(&a,&c),0);
+
+    bigint_free(&a);
+    bigint_free(&b);
+    bigint_free(&c);
+}
+
+UTEST(bigint,add_grow_after_shrink) {
+    PREAMBLE
+
+    /* c is larger than the result, so the result has to clear
+     * the words left over from the old value */
+    ASSERT_EQ(bigint_from_cstring(&c,"0xffffffffffffffffffffffffffffffffffffffffffffffffffffffff",16),0);
+    ASSERT_EQ(bigint_from_u8(&a,1),0);
+    ASSERT_EQ(bigint_from_cstring(&b,"0x1000000000000000000000000",16),0);
+    ASSERT_EQ(bigint_from_cstring(&d,"0x1000000000000000000000001",16),0);
+
+    ASSERT_EQ(bigint_add(&c,&a,&b),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    CLEANUP
+}
+
+UTEST(bigint,add_sub_alias) {
+    PREAMBLE
+
+    ASSERT_EQ(bigint_from_cstring(&a,"123456789012345678901234567890",10),0);
+    ASSERT_EQ(bigint_from_cstring(&b,"-98765432109876543210",10),0);
+
+    /* c = c + b */
+    ASSERT_EQ(bigint_copy(&c,&a),0);
+    ASSERT_EQ(bigint_add(&c,&c,&b),0);
+    ASSERT_EQ(bigint_add(&d,&a,&b),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    /* c = a - c, where the result changes sign */
+    ASSERT_EQ(bigint_copy(&c,&b),0);
+    ASSERT_EQ(bigint_sub(&c,&b,&c),0);
+    ASSERT_EQ(c.size,(size_t)0);
+    ASSERT_EQ(c.sign,(size_t)0);
+    ASSERT_EQ(bigint_copy(&c,&a),0);
+    ASSERT_EQ(bigint_sub(&c,&b,&c),0);
+    ASSERT_EQ(bigint_sub(&d,&b,&a),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+    ASSERT_EQ(c.sign,(size_t)1);
+
+    /* c = c + c and c = c - c */
+    ASSERT_EQ(bigint_copy(&c,&b),0);
+    ASSERT_EQ(bigint_add(&c,&c,&c),0);
+    ASSERT_EQ(bigint_add(&d,&b,&b),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+    ASSERT_EQ(bigint_sub(&c,&c,&c),0);
+    ASSERT_EQ(c.size,(size_t)0);
+    ASSERT_EQ(c.sign,(size_t)0);
+
+    /* c = c * b and c = a * c */
+    ASSERT_EQ(bigint_copy(&c,&a),0);
+    ASSERT_EQ(bigint_mul(&c,&c,&b),0);
+    ASSERT_EQ(bigint_mul(&d,&a,&b),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+    ASSERT_EQ(bigint_copy(&c,&b),0);
+    ASSERT_EQ(bigint_mul(&c,&a,&c),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    CLEANUP
+}
+
 UTEST(bigint,add_unsigned) {
     bigint a;
     bigint b;
@@ -1807,6 +2450,471 @@ UTEST(bigint_positive,mul_negative_carry) {
     CLEANUP
 }
 
+UTEST(bigint_positive,mul_karatsuba) {
+    PREAMBLE
+
+    ASSERT_EQ(fill_bigint(&a,BIGINT_KARATSUBA_THRESHOLD * 2 + 3,1),0);
+    ASSERT_EQ(fill_bigint(&b,BIGINT_KARATSUBA_THRESHOLD + 5,2),0);
+
+    ASSERT_EQ(bigint_mul_karatsuba(&c,&a,&b),0);
+    ASSERT_EQ(bigint_mul_long(&d,&a,&b),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    ASSERT_EQ(bigint_mul_karatsuba(&c,&b,&a),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    ASSERT_EQ(fill_bigint(&b,BIGINT_KARATSUBA_THRESHOLD * 2,3),0);
+    ASSERT_EQ(bigint_mul_karatsuba(&c,&a,&b),0);
+    ASSERT_EQ(bigint_mul_long(&d,&a,&b),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    CLEANUP
+}
+
+UTEST(bigint_positive,mul_karatsuba_signed) {
+    PREAMBLE
+
+    ASSERT_EQ(fill_bigint(&a,BIGINT_KARATSUBA_THRESHOLD * 3,4),0);
+    ASSERT_EQ(fill_bigint(&b,BIGINT_KARATSUBA_THRESHOLD * 2 + 1,5),0);
+    ASSERT_EQ(bigint_mul_long(&d,&a,&b),0);
+
+    b.sign = 1;
+    ASSERT_EQ(bigint_mul(&c,&a,&b),0);
+    ASSERT_EQ(c.sign,(size_t)1);
+    c.sign = 0;
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    a.sign = 1;
+    ASSERT_EQ(bigint_mul(&c,&a,&b),0);
+    ASSERT_EQ(c.sign,(size_t)0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    /* c starts out with a value that must not leak into the result */
+    ASSERT_EQ(bigint_from_u8(&c,5),0);
+    ASSERT_EQ(bigint_mul(&c,&a,&b),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    CLEANUP
+}
+
+UTEST(bigint_positive,mul_toom3) {
+    PREAMBLE
+
+    ASSERT_EQ(fill_bigint(&a,99,6),0);
+    ASSERT_EQ(fill_bigint(&b,97,7),0);
+
+    ASSERT_EQ(bigint_mul_toom3(&c,&a,&b),0);
+    ASSERT_EQ(bigint_mul_long(&d,&a,&b),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    ASSERT_EQ(bigint_mul_toom3(&c,&b,&a),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    /* all ones makes every evaluation point carry */
+    ASSERT_EQ(bigint_resize(&a,30),0);
+    ASSERT_EQ(bigint_resize(&b,28),0);
+    memset(a.words,0xFF,30 * sizeof(bigint_word));
+    memset(b.words,0xFF,28 * sizeof(bigint_word));
+    ASSERT_EQ(bigint_mul_toom3(&c,&a,&b),0);
+    ASSERT_EQ(bigint_mul_long(&d,&a,&b),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    CLEANUP
+}
+
+UTEST(bigint_positive,mul_toom3_dispatch) {
+    PREAMBLE
+
+    ASSERT_EQ(fill_bigint(&a,BIGINT_TOOM3_THRESHOLD + 7,8),0);
+    ASSERT_EQ(fill_bigint(&b,BIGINT_TOOM3_THRESHOLD + 1,9),0);
+    b.sign = 1;
+
+    ASSERT_EQ(bigint_mul(&c,&a,&b),0);
+    ASSERT_EQ(bigint_mul_long(&d,&a,&b),0);
+    ASSERT_EQ(c.sign,(size_t)1);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    CLEANUP
+}
+
+UTEST(bigint_positive,sqr_long) {
+    PREAMBLE
+
+    ASSERT_EQ(fill_bigint(&a,37,12),0);
+    ASSERT_EQ(bigint_sqr_long(&c,&a),0);
+    ASSERT_EQ(bigint_mul_long(&d,&a,&a),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    ASSERT_EQ(bigint_resize(&a,20),0);
+    memset(a.words,0xFF,20 * sizeof(bigint_word));
+    ASSERT_EQ(bigint_sqr_long(&c,&a),0);
+    ASSERT_EQ(bigint_mul_long(&d,&a,&a),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    ASSERT_EQ(bigint_sqr_long(&c,BIGINT_ZERO),0);
+    ASSERT_EQ(c.size,(size_t)0);
+
+    CLEANUP
+}
+
+UTEST(bigint_positive,sqr) {
+    PREAMBLE
+
+    ASSERT_EQ(fill_bigint(&a,BIGINT_TOOM3_THRESHOLD + 2,13),0);
+    a.sign = 1;
+    ASSERT_EQ(bigint_mul_long(&d,&a,&a),0);
+    ASSERT_EQ(d.sign,(size_t)0);
+
+    ASSERT_EQ(bigint_sqr(&c,&a),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    ASSERT_EQ(bigint_mul(&c,&a,&a),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    ASSERT_EQ(bigint_mul_karatsuba(&c,&a,&a),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    ASSERT_EQ(bigint_mul_toom3(&c,&a,&a),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    /* squaring in place */
+    ASSERT_EQ(bigint_sqr(&a,&a),0);
+    ASSERT_EQ(bigint_cmp(&a,&d),0);
+
+    CLEANUP
+}
+
+#ifndef BIGINT_NO_MALLOC
+UTEST(bigint_positive,mul_ntt) {
+    PREAMBLE
+
+    ASSERT_EQ(fill_bigint(&a,200,10),0);
+    ASSERT_EQ(fill_bigint(&b,150,11),0);
+
+    ASSERT_EQ(bigint_mul_ntt(&c,&a,&b),0);
+    ASSERT_EQ(bigint_mul_long(&d,&a,&b),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    ASSERT_EQ(bigint_mul_ntt(&c,&a,&a),0);
+    ASSERT_EQ(bigint_mul_long(&d,&a,&a),0);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    /* all ones gives the largest possible convolution terms */
+    ASSERT_EQ(bigint_resize(&a,100),0);
+    memset(a.words,0xFF,100 * sizeof(bigint_word));
+    b.sign = 1;
+    ASSERT_EQ(bigint_mul_ntt(&c,&a,&b),0);
+    ASSERT_EQ(bigint_mul_long(&d,&a,&b),0);
+    ASSERT_EQ(c.sign,(size_t)1);
+    ASSERT_EQ(bigint_cmp(&c,&d),0);
+
+    ASSERT_EQ(bigint_from_u8(&a,3),0);
+    ASSERT_EQ(bigint_mul_ntt(&c,&a,&a),0);
+    ASSERT_EQ(c.size,(size_t)1);
+    ASSERT_WEQ(c.words[0],9);
+
+    ASSERT_EQ(bigint_mul_ntt(&c,&a,BIGINT_ZERO),0);
+    ASSERT_EQ(c.size,(size_t)0);
+
+    CLEANUP
+}
+
+typedef struct counting_allocator {
+    size_t live;  /* bytes currently allocated */
+    size_t calls; /* number of alloc/realloc calls */
+} counting_allocator;
+
+/* every block carries its size so frees can be checked */
+static void* counting_alloc(void* user, size_t size) {
+    counting_allocator* c = (counting_allocator*)user;
+    size_t* p = (size_t*)malloc(sizeof(size_t) + size);
+    if(p == NULL) return NULL;
+    *p = size;
+    c->live += size;
+    c->calls++;
+    return p + 1;
+}
+
+static void* counting_realloc(void* user, void* ptr, size_t old_size, size_t new_size) {
+    counting_allocator* c = (counting_allocator*)user;
+    size_t* p = (size_t*)ptr - 1;
+    if(*p != old_size) return NULL;
+    p = (size_t*)realloc(p, sizeof(size_t) + new_size);
+    if(p == NULL) return NULL;
+    *p = new_size;
+    c->live += new_size - old_size;
+    c->calls++;
+    return p + 1;
+}
+
+static void counting_free(void* user, void* ptr, size_t size) {
+    counting_allocator* c = (counting_allocator*)user;
+    size_t* p = (size_t*)ptr - 1;
+    assert(*p == size);
+    c->live -= size;
+    free(p);
+}
+
+/* fills every new block, and the grown part of a realloc, with 0xA5 so
+ * reads of storage nobody wrote show up as wrong results */
+static void* poison_alloc(void* user, size_t size) {
+    void* p = counting_alloc(user, size);
+    if(p != NULL) memset(p, 0xA5, size);
+    return p;
+}
+
+static void* poison_realloc(void* user, void* ptr, size_t old_size, size_t new_size) {
+    unsigned char* p = (unsigned char*)counting_realloc(user, ptr, old_size, new_size);
+    if(p != NULL && new_size > old_size) memset(p + old_size, 0xA5, new_size - old_size);
+    return p;
+}
+
+UTEST(bigint,allocator) {
+    counting_allocator counter = { 0, 0 };
+    bigint_allocator hooks = { counting_alloc, counting_realloc, counting_free, NULL };
+    bigint_allocator current;
+    int pass;
+    PREAMBLE
+
+    hooks.user = &counter;
+    for(pass = 0; pass < 2; pass++) {
+        /* the second pass leaves out realloc */
+        if(pass) hooks.realloc_fn = NULL;
+        bigint_set_allocator(&hooks);
+        bigint_get_allocator(&current);
+        ASSERT_TRUE(current.user == &counter);
+
+        ASSERT_EQ(fill_bigint(&a,200,10),0);
+        ASSERT_EQ(fill_bigint(&b,150,11),0);
+        ASSERT_EQ(bigint_mul_ntt(&c,&a,&b),0);
+        ASSERT_EQ(bigint_mul_long(&d,&a,&b),0);
+        ASSERT_EQ(bigint_cmp(&c,&d),0);
+        ASSERT_EQ(bigint_div_mod(&c,&d,&d,&b),0);
+        ASSERT_EQ(bigint_cmp(&c,&a),0);
+        ASSERT_TRUE(counter.calls > 0);
+        ASSERT_TRUE(counter.live > 0);
+
+        CLEANUP
+        ASSERT_TRUE(counter.live == 0);
+        bigint_set_allocator(NULL);
+    }
+
+    /* a value built a word at a time grows geometrically */
+    bigint_set_allocator(&hooks);
+    counter.calls = 0;
+    a.limit = 4096 * sizeof(bigint_word);
+    for(pass = 0; pass < 4096; pass++) {
+        ASSERT_EQ(bigint_append(&a,1),0);
+    }
+    ASSERT_TRUE(counter.calls < 32);
+    bigint_free(&a);
+    ASSERT_TRUE(counter.live == 0);
+    bigint_set_allocator(NULL);
+
+    bigint_get_allocator(&current);
+    ASSERT_TRUE(current.user == NULL);
+    counter.calls = 0;
+    ASSERT_EQ(bigint_from_u32(&a,12345),0);
+    ASSERT_TRUE(counter.calls == 0);
+    bigint_free(&a);
+}
+
+UTEST(bigint,poisoned_storage) {
+    counting_allocator counter = { 0, 0 };
+    bigint_allocator hooks = { poison_alloc, poison_realloc, counting_free, NULL };
+    bigint e = BIGINT_INIT;
+    bigint f = BIGINT_INIT;
+    bigint g = BIGINT_INIT;
+    bigint h = BIGINT_INIT;
+    bigint k = BIGINT_INIT;
+    bigint q = BIGINT_INIT;
+    PREAMBLE
+
+    /* inputs and expected values, made with the default allocator. b
+     * takes division to Burnikel-Ziegler, k stays with Knuth */
+    ASSERT_EQ(fill_bigint(&a,2 * BIGINT_BZ_THRESHOLD + 7,10),0);
+    ASSERT_EQ(fill_bigint(&b,BIGINT_BZ_THRESHOLD + 3,11),0);
+    ASSERT_EQ(fill_bigint(&k,BIGINT_BZ_THRESHOLD / 2,12),0);
+    ASSERT_EQ(bigint_mul_long(&e,&a,&b),0);
+    ASSERT_EQ(bigint_sqr(&f,&b),0);
+    ASSERT_EQ(bigint_div_mod(&g,&h,&a,&b),0);
+    ASSERT_EQ(bigint_div_mod(&q,&d,&a,&k),0);
+    bigint_free(&d);
+
+    hooks.user = &counter;
+    bigint_set_allocator(&hooks);
+
+    ASSERT_EQ(bigint_mul_long(&c,&a,&b),0);
+    ASSERT_EQ(bigint_cmp(&c,&e),0);
+    bigint_free(&c);
+    ASSERT_EQ(bigint_mul_ntt(&c,&a,&b),0);
+    ASSERT_EQ(bigint_cmp(&c,&e),0);
+    bigint_free(&c);
+    ASSERT_EQ(bigint_sqr(&c,&b),0);
+    ASSERT_EQ(bigint_cmp(&c,&f),0);
+    bigint_free(&c);
+    ASSERT_EQ(bigint_div_mod(&c,&d,&a,&b),0);
+    ASSERT_EQ(bigint_cmp(&c,&g),0);
+    ASSERT_EQ(bigint_cmp(&d,&h),0);
+    bigint_free(&c);
+    bigint_free(&d);
+    ASSERT_EQ(bigint_div_mod(&c,&d,&a,&k),0);
+    ASSERT_EQ(bigint_cmp(&c,&q),0);
+    bigint_free(&c);
+    ASSERT_EQ(bigint_divexact(&c,&e,&b),0);
+    ASSERT_EQ(bigint_cmp(&c,&a),0);
+    bigint_free(&c);
+    ASSERT_EQ(bigint_copy(&c,&a),0);
+    ASSERT_EQ(bigint_cmp(&c,&a),0);
+    bigint_free(&c);
+    ASSERT_EQ(bigint_lshift(&c,&b,3 * BIGINT_WORD_BIT + 5),0);
+    ASSERT_EQ(bigint_rshift(&c,&c,3 * BIGINT_WORD_BIT + 5),0);
+    ASSERT_EQ(bigint_cmp(&c,&b),0);
+
+    bigint_free(&c);
+    bigint_free(&d);
+    ASSERT_TRUE(counter.live == 0);
+    bigint_set_allocator(NULL);
+
+    CLEANUP
+    bigint_free(&e);
+    bigint_free(&f);
+    bigint_free(&g);
+    bigint_free(&h);
+    bigint_free(&k);
+    bigint_free(&q);
+}
+
+UTEST(bigint,strlen_exact_alloc) {
+    counting_allocator counter = { 0, 0 };
+    bigint_allocator hooks = { counting_alloc, counting_realloc, counting_free, NULL };
+    static char buffer[16384];
+    size_t la[37];
+    size_t lb[37];
+    unsigned int base;
+    PREAMBLE
+
+    ASSERT_EQ(fill_bigint(&a,40,10),0);
+    ASSERT_EQ(fill_bigint(&b,200,11),0);
+    b.sign = 1;
+    for(base = 3; base <= 36; base++) {
+        la[base] = bigint_to_string(buffer,sizeof(buffer),&a,base);
+        lb[base] = bigint_to_string(buffer,sizeof(buffer),&b,base);
+    }
+
+    /* away from a power of the base the length comes from the top
+     * bits, without building the power */
+    hooks.user = &counter;
+    bigint_set_allocator(&hooks);
+    for(base = 3; base <= 36; base++) {
+        ASSERT_EQ(bigint_strlen_exact(&a,base),la[base]);
+        ASSERT_EQ(bigint_strlen_exact(&b,base),lb[base]);
+    }
+    ASSERT_TRUE(counter.calls == 0);
+    bigint_set_allocator(NULL);
+
+    CLEANUP
+}
+
+UTEST(bigint,scratch) {
+    counting_allocator counter = { 0, 0 };
+    bigint_allocator hooks = { counting_alloc, counting_realloc, counting_free, NULL };
+    bigint_scratch scratch;
+    bigint e = BIGINT_INIT;
+    bigint f = BIGINT_INIT;
+    size_t calls;
+    int pass;
+    PREAMBLE
+
+    hooks.user = &counter;
+    bigint_set_allocator(&hooks);
+    bigint_scratch_init(&scratch);
+
+    ASSERT_EQ(fill_bigint(&a,60,10),0);
+    ASSERT_EQ(fill_bigint(&b,25,11),0);
+    b.sign = 1;
+
+    /* the first pass grows everything, the second shouldn't allocate */
+    for(pass = 0; pass < 2; pass++) {
+        calls = counter.calls;
+        ASSERT_EQ(bigint_mul_scratch(&c,&a,&b,&scratch),0);
+        ASSERT_EQ(bigint_mul(&d,&a,&b),0);
+        ASSERT_EQ(bigint_cmp(&c,&d),0);
+        ASSERT_EQ(bigint_sqr_scratch(&c,&a,&scratch),0);
+        ASSERT_EQ(bigint_sqr(&d,&a),0);
+        ASSERT_EQ(bigint_cmp(&c,&d),0);
+        ASSERT_EQ(bigint_add_scratch(&c,&a,&b,&scratch),0);
+        ASSERT_EQ(bigint_add(&d,&a,&b),0);
+        ASSERT_EQ(bigint_cmp(&c,&d),0);
+        ASSERT_EQ(bigint_sub_scratch(&c,&c,&b,&scratch),0);
+        ASSERT_EQ(bigint_cmp(&c,&a),0);
+        ASSERT_EQ(bigint_div_mod_scratch(&c,&d,&a,&b,&scratch),0);
+        ASSERT_EQ(bigint_div_mod(&e,&f,&a,&b),0);
+        ASSERT_EQ(bigint_cmp(&c,&e),0);
+        ASSERT_EQ(bigint_cmp(&d,&f),0);
+        ASSERT_TRUE(scratch.used == 0);
+        if(pass) {
+            /* the plain calls still use fresh temporaries */
+            ASSERT_TRUE(counter.calls > calls);
+            calls = counter.calls;
+            ASSERT_EQ(bigint_mul_scratch(&c,&a,&b,&scratch),0);
+            ASSERT_EQ(bigint_div_mod_scratch(&c,&d,&a,&b,&scratch),0);
+            ASSERT_TRUE(counter.calls == calls);
+        }
+    }
+
+    bigint_scratch_reset(&scratch);
+    bigint_scratch_free(&scratch);
+    CLEANUP
+    bigint_free(&e);
+    bigint_free(&f);
+    ASSERT_TRUE(counter.live == 0);
+    bigint_set_allocator(NULL);
+}
+
+#ifdef BIGINT_INLINE_WORDS
+UTEST(bigint,inline_words) {
+    counting_allocator counter = { 0, 0 };
+    bigint_allocator hooks = { counting_alloc, counting_realloc, counting_free, NULL };
+    size_t i;
+    PREAMBLE
+
+    hooks.user = &counter;
+    bigint_set_allocator(&hooks);
+
+    ASSERT_EQ(bigint_from_word(&a,(bigint_word)-1),0);
+    ASSERT_EQ(bigint_from_word(&b,3),0);
+    ASSERT_EQ(bigint_mul(&c,&a,&b),0);
+    ASSERT_EQ(bigint_add(&c,&c,&a),0);
+    ASSERT_TRUE(c.words == c.inline_words);
+    ASSERT_WEQ(c.size,2);
+    ASSERT_WEQ(c.words[0],(bigint_word)-4);
+    ASSERT_WEQ(c.words[1],3);
+    ASSERT_TRUE(counter.calls == 0);
+
+    /* growing past the inline words moves the value to the heap */
+    ASSERT_EQ(bigint_lshift(&d,&c,BIGINT_INLINE_WORDS * BIGINT_WORD_BIT),0);
+    ASSERT_TRUE(d.words != d.inline_words);
+    ASSERT_TRUE(counter.calls == 1);
+    for(i = 0; i < BIGINT_INLINE_WORDS; i++) {
+        ASSERT_WEQ(d.words[i],0);
+    }
+    ASSERT_WEQ(d.words[BIGINT_INLINE_WORDS],(bigint_word)-4);
+    ASSERT_WEQ(d.words[BIGINT_INLINE_WORDS+1],3);
+
+    ASSERT_EQ(bigint_resize(&c,BIGINT_INLINE_WORDS + 2),0);
+    ASSERT_TRUE(c.words != c.inline_words);
+    ASSERT_WEQ(c.words[0],(bigint_word)-4);
+    ASSERT_WEQ(c.words[1],3);
+
+    CLEANUP
+    ASSERT_TRUE(counter.live == 0);
+    ASSERT_TRUE(c.words == NULL);
+    bigint_set_allocator(NULL);
+}
+#endif
+#endif
+
 UTEST(bigint_positive,div_positive) {
     PREAMBLE
 
@@ -1893,6 +3001,126 @@ UTEST(bigint_positive,div_negative_carry) {
     CLEANUP
 }
 
+UTEST(bigint_positive,div_long) {
+    PREAMBLE
+    bigint e = BIGINT_INIT;
+
+    /* q * b + r == a, and |r| < |b| */
+    ASSERT_EQ(fill_bigint(&a,70,21),0);
+    ASSERT_EQ(fill_bigint(&b,31,22),0);
+    a.sign = 1;
+    ASSERT_EQ(bigint_div_mod(&d,&c,&a,&b),0);
+    ASSERT_EQ(d.sign,(size_t)1);
+    ASSERT_EQ(c.sign,(size_t)1);
+    ASSERT_LT(bigint_cmp_abs(&c,&b),0);
+    ASSERT_EQ(bigint_mul(&e,&d,&b),0);
+    ASSERT_EQ(bigint_add(&e,&e,&c),0);
+    ASSERT_EQ(bigint_cmp(&e,&a),0);
+
+    /* top words equal, the quotient word estimate saturates */
+    ASSERT_EQ(bigint_resize(&a,3),0);
+    ASSERT_EQ(bigint_resize(&b,2),0);
+    a.sign = 0;
+    a.words[2] = ((bigint_word)-1) >> 1;
+    a.words[1] = 0;
+    a.words[0] = 5;
+    b.words[1] = ((bigint_word)-1) >> 1;
+    b.words[0] = ((bigint_word)-1);
+    ASSERT_EQ(bigint_div_mod(&d,&c,&a,&b),0);
+    ASSERT_LT(bigint_cmp_abs(&c,&b),0);
+    ASSERT_EQ(bigint_mul(&e,&d,&b),0);
+    ASSERT_EQ(bigint_add(&e,&e,&c),0);
+    ASSERT_EQ(bigint_cmp(&e,&a),0);
+
+    /* single word divisor that doesn't fit in a half word */
+    ASSERT_EQ(bigint_resize(&b,1),0);
+    b.words[0] = ((bigint_word)-1) - 2;
+    ASSERT_EQ(bigint_div_mod(&d,&c,&a,&b),0);
+    ASSERT_LT(bigint_cmp_abs(&c,&b),0);
+    ASSERT_EQ(bigint_mul(&e,&d,&b),0);
+    ASSERT_EQ(bigint_add(&e,&e,&c),0);
+    ASSERT_EQ(bigint_cmp(&e,&a),0);
+
+    /* |a| < |b| */
+    ASSERT_EQ(bigint_div_mod(&d,&c,&b,&a),0);
+    ASSERT_EQ(d.size,(size_t)0);
+    ASSERT_EQ(bigint_cmp(&c,&b),0);
+
+    ASSERT_EQ(bigint_div_mod(&d,&c,&a,BIGINT_ZERO),BIGINT_EINVAL);
+
+    bigint_free(&e);
+    CLEANUP
+}
+
+#ifndef BIGINT_NO_MALLOC
+UTEST(bigint_positive,div_bz) {
+    PREAMBLE
+    bigint e = BIGINT_INIT;
+    bigint f = BIGINT_INIT;
+
+    ASSERT_EQ(fill_bigint(&a,3 * BIGINT_BZ_THRESHOLD,23),0);
+    ASSERT_EQ(fill_bigint(&b,BIGINT_BZ_THRESHOLD + 5,24),0);
+
+    ASSERT_EQ(bigint_div_mod_bz(&d,&c,&a,&b),0);
+    ASSERT_EQ(bigint_div_mod_unsigned(&e,&f,&a,&b,NULL),0);
+    ASSERT_EQ(bigint_cmp(&d,&e),0);
+    ASSERT_EQ(bigint_cmp(&c,&f),0);
+
+    /* a multiple of b, through the public function */
+    ASSERT_EQ(bigint_mul(&e,&a,&b),0);
+    b.sign = 1;
+    ASSERT_EQ(bigint_div_mod(&d,&c,&e,&b),0);
+    ASSERT_EQ(c.size,(size_t)0);
+    ASSERT_EQ(d.sign,(size_t)1);
+    d.sign = 0;
+    ASSERT_EQ(bigint_cmp(&d,&a),0);
+
+    bigint_free(&e);
+    bigint_free(&f);
+    CLEANUP
+}
+#endif
+
+UTEST(bigint_positive,div_mod_preinv) {
+    PREAMBLE
+    bigint e = BIGINT_INIT;
+    bigint f = BIGINT_INIT;
+    bigint_preinv p;
+    size_t sizes[2] = { 3, BIGINT_BZ_THRESHOLD + 3 };
+    size_t i;
+
+    for(i = 0; i < 2; i++) {
+        ASSERT_EQ(fill_bigint(&b,sizes[i],25),0);
+        b.sign = 1;
+        ASSERT_EQ(bigint_preinv_init(&p,&b),0);
+
+        ASSERT_EQ(fill_bigint(&a,3 * sizes[i] + 2,26),0);
+        ASSERT_EQ(bigint_div_mod_preinv(&d,&c,&a,&p),0);
+        ASSERT_EQ(bigint_div_mod(&e,&f,&a,&b),0);
+        ASSERT_EQ(bigint_cmp(&d,&e),0);
+        ASSERT_EQ(bigint_cmp(&c,&f),0);
+
+        /* exact multiple */
+        ASSERT_EQ(bigint_mul(&a,&b,&e),0);
+        ASSERT_EQ(bigint_div_mod_preinv(&d,&c,&a,&p),0);
+        ASSERT_EQ(c.size,(size_t)0);
+        ASSERT_EQ(bigint_cmp(&d,&e),0);
+
+        /* |a| < |b| */
+        ASSERT_EQ(bigint_div_mod_preinv(&d,&c,&f,&p),0);
+        ASSERT_EQ(d.size,(size_t)0);
+        ASSERT_EQ(bigint_cmp(&c,&f),0);
+
+        bigint_preinv_free(&p);
+    }
+
+    ASSERT_EQ(bigint_preinv_init(&p,BIGINT_ZERO),BIGINT_EINVAL);
+
+    bigint_free(&e);
+    bigint_free(&f);
+    CLEANUP
+}
+
 UTEST(bigint_positive,lshift_whole_word) {
     PREAMBLE;
 
@@ -1969,6 +3197,63 @@ UTEST(bigint_positive,div_mod_word) {
     CLEANUP
 }
 
+UTEST(bigint_positive,div_mod_word_large) {
+    PREAMBLE;
+    bigint_word rem;
+    bigint_word den[3];
+    size_t i;
+
+    /* denominators that don't fit in a half word, normalized or not */
+    den[0] = ((bigint_word)-1);
+    den[1] = ((bigint_word)-1) >> 1;
+    den[2] = ((bigint_word)1 << (BIGINT_WORD_BIT - 1)) + 3;
+
+    for(i = 0; i < 3; i++) {
+        ASSERT_EQ(fill_bigint(&a,9,27),0);
+        ASSERT_EQ(bigint_from_word(&b,den[i]),0);
+        ASSERT_EQ(bigint_div_mod(&d,&c,&a,&b),0);
+
+        bigint_div_mod_word(&a, &rem, den[i]);
+        ASSERT_EQ(bigint_cmp(&a,&d),0);
+        ASSERT_EQ(c.size,(size_t)(rem != 0));
+        if(c.size) ASSERT_WEQ(c.words[0],rem);
+    }
+
+    CLEANUP
+}
+
+UTEST(bigint_positive,divexact) {
+    PREAMBLE
+    bigint e = BIGINT_INIT;
+
+    /* even divisor, so the trailing zeros get stripped */
+    ASSERT_EQ(fill_bigint(&a,17,28),0);
+    ASSERT_EQ(fill_bigint(&b,9,29),0);
+    b.words[0] = 0;
+    b.words[1] &= ~(bigint_word)1;
+    b.sign = 1;
+    ASSERT_EQ(bigint_mul(&c,&a,&b),0);
+
+    ASSERT_EQ(bigint_divexact(&d,&c,&b),0);
+    ASSERT_EQ(bigint_cmp(&d,&a),0);
+
+    ASSERT_EQ(bigint_divexact(&d,&c,&a),0);
+    ASSERT_EQ(bigint_cmp(&d,&b),0);
+
+    ASSERT_EQ(bigint_divexact(&d,BIGINT_ZERO,&b),0);
+    ASSERT_EQ(d.size,(size_t)0);
+    ASSERT_EQ(bigint_divexact(&d,&c,BIGINT_ZERO),BIGINT_EINVAL);
+
+    /* word version */
+    ASSERT_EQ(bigint_from_word(&e,((bigint_word)-1) - 1),0);
+    ASSERT_EQ(bigint_mul(&c,&a,&e),0);
+    bigint_divexact_word(&c,((bigint_word)-1) - 1);
+    ASSERT_EQ(bigint_cmp(&c,&a),0);
+
+    bigint_free(&e);
+    CLEANUP
+}
+
 UTEST(bigint_negative,add_zero) {
     PREAMBLE
 